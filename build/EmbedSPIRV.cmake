@@ -0,0 +1,6 @@
+# writes the SPIR-V at INPUT to OUTPUT as a uint32_t array named NAME, see UIPipeline.cpp
+# usage: cmake -DINPUT=<.spv> -DOUTPUT=<.h> -DNAME=<array name> -P EmbedSPIRV.cmake
+file(READ ${INPUT} hex HEX)
+# SPIR-V words are little-endian
+string(REGEX REPLACE "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])" "0x\\4\\3\\2\\1,\n" words ${hex})
+file(WRITE ${OUTPUT} "// generated from ${INPUT} by EmbedSPIRV.cmake\nstatic const uint32_t ${NAME}[] = {\n${words}};\n")
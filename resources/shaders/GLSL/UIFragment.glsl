@@ -1,21 +1,61 @@
 #version 460
 
+// must match UIPushConstantData followed by UIChromeData
 layout(push_constant) uniform Constants {
 	vec4 bgcolor;
 	vec2 position, extent;
-	bool blend;
+	uint flags;
+	float cornerradius, borderwidth, shadowblur;
+	vec4 bordercolor, shadowcolor;
+	vec2 shadowoffset;
 } constants;
 
 layout(location = 0) in vec2 uv;
 layout(location = 1) in vec2 pos;
+layout(location = 2) in vec2 local;
 
 layout(binding = 0) uniform sampler2D tex;
 
 layout(location = 0) out vec4 color;
 
+// signed distance from p to a box of half-extent b with corner radius r, all relative to the box's center
+float roundedBoxSDF(vec2 p, vec2 b, float r) {
+	vec2 q = abs(p) - b + vec2(r);
+	return length(max(q, 0.)) + min(max(q.x, q.y), 0.) - r;
+}
+
 void main() {
+	bool chrome = constants.cornerradius > 0 || constants.borderwidth > 0 || constants.shadowcolor.a > 0;
 	// at some point, may be worth differentiating text versus non-text shaders
 	// then, in non-text we could specify tex or no-tex (avoid erroneous sampling)
-	if (constants.blend) color = mix(constants.bgcolor, vec4(1, 1, 1, 1), texture(tex, uv).r);
-	else color = texture(tex, uv);
+	vec4 fill;
+	// the part of the texture in use, see UI_PC_TEX_REGION_SHIFT
+	uvec2 region = uvec2(bitfieldExtract(constants.flags, 4, 14), bitfieldExtract(constants.flags, 18, 14));
+	vec2 st = region.x == 0 ? uv : uv * vec2(region) / vec2(textureSize(tex, 0));
+	// UI_PC_FLAG_BLEND, text coverage over the background
+	if ((constants.flags & 1u) != 0) fill = mix(constants.bgcolor, vec4(1, 1, 1, 1), texture(tex, st).r);
+	// styled but untextured (no UI_PC_FLAG_TEX) components are a flat color, no need to sample
+	else if (chrome && (constants.flags & 2u) == 0) fill = constants.bgcolor;
+	else fill = texture(tex, st);
+	if (!chrome) {
+		color = fill;
+		return;
+	}
+
+	vec2 halfext = constants.extent * 0.5;
+	float r = min(constants.cornerradius, min(halfext.x, halfext.y));
+	float d = roundedBoxSDF(local - halfext, halfext, r);
+	if (constants.borderwidth > 0) fill = mix(fill, constants.bordercolor, clamp(d + constants.borderwidth + 0.5, 0., 1.));
+	fill.a *= clamp(0.5 - d, 0., 1.);
+
+	vec4 shadow = vec4(0);
+	if (constants.shadowcolor.a > 0) {
+		float sd = roundedBoxSDF(local - halfext - constants.shadowoffset, halfext, r);
+		float blur = max(constants.shadowblur, 0.5);
+		shadow = constants.shadowcolor;
+		shadow.a *= 1 - smoothstep(-blur, blur, sd);
+	}
+	// fill over shadow, un-premultiplied
+	float a = fill.a + shadow.a * (1 - fill.a);
+	color = a > 0 ? vec4((fill.rgb * fill.a + shadow.rgb * shadow.a * (1 - fill.a)) / a, a) : vec4(0);
 }
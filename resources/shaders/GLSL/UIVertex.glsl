@@ -1,22 +1,21 @@
 #version 460
 
-#define SCREEN_WIDTH 3584
-#define SCREEN_HEIGHT 2240
+// specialization constants so the same SPIR-V works at any resolution, see UIPipelineBuilder
+layout(constant_id = 0) const float SCREEN_WIDTH = 3584;
+layout(constant_id = 1) const float SCREEN_HEIGHT = 2240;
 #define SCREEN_VEC vec2(SCREEN_WIDTH, SCREEN_HEIGHT)
 
+// must match UIPushConstantData followed by UIChromeData
 layout(push_constant) uniform Constants {
 	vec4 bgcolor;
 	vec2 position, extent;
+	uint flags;
+	float cornerradius, borderwidth, shadowblur;
+	vec4 bordercolor, shadowcolor;
+	vec2 shadowoffset;
 } constants;
 
-// wouldn't let me make this const, may need to do some keyword hacking w/ defs of push constants
-vec2 vertexpositions[4] = {
-	(constants.position) / SCREEN_VEC * 2 - vec2(1),
-	(constants.position + vec2(constants.extent.x, 0)) / SCREEN_VEC * 2 - vec2(1), 
-	(constants.position + constants.extent) / SCREEN_VEC * 2 - vec2(1), 
-	(constants.position + vec2(0, constants.extent.y)) / SCREEN_VEC * 2 - vec2(1) 
-};
-const vec2 vertexuvs[4] = {
+const vec2 vertexcorners[4] = {
     vec2(0., 0.),
     vec2(1., 0.),
     vec2(1., 1.),
@@ -29,10 +28,15 @@ const uint vertexindices[6] = {
 
 layout(location = 0) out vec2 uv;
 layout(location = 1) out vec2 pos;
+// pixel offset from constants.position
+layout(location = 2) out vec2 local;
 
 void main() {
-	pos = vertexpositions[vertexindices[gl_VertexIndex]];
+	// grow the quad to fit the shadow, uv still spans just position to position + extent
+	vec2 margin = constants.shadowcolor.a > 0 ? vec2(constants.shadowblur) + abs(constants.shadowoffset) : vec2(0);
+	local = mix(-margin, constants.extent + margin, vertexcorners[vertexindices[gl_VertexIndex]]);
+	uv = local / constants.extent;
+	pos = (constants.position + local) / SCREEN_VEC * 2 - vec2(1);
 	pos.y *= -1;
 	gl_Position = vec4(pos, 0, 1);
-	uv = vertexuvs[vertexindices[gl_VertexIndex]];
 }
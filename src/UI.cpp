@@ -1,4 +1,84 @@
 #include "UI.h"
+#include "UIPNG.h"
+#include "UICompress.h"
+#include <cstdio>
+#include <chrono>
+#include <list>
+
+// large trees are memory- and cache-bound, anything shared belongs in UIStyle instead
+static_assert(sizeof(UIComponent) <= 64, "UIComponent footprint regression");
+// UIFragment.glsl expects chrome to start right after flags, and everything to fit in the guaranteed 128 bytes
+static_assert(sizeof(UIPushConstantData) == 36, "UIPushConstantData no longer matches the shaders");
+static_assert(sizeof(UIPushConstantData) + sizeof(UIChromeData) <= 128, "push constants too large");
+
+/*
+ * ----------------
+ * | UIRecordPool |
+ * ----------------
+ */
+
+/*
+ * Threads UIComponent::drawParallel records on. They're started the first time they're needed and kept for
+ * later frames, and the calling thread works alongside them.
+ */
+class UIRecordPool {
+public:
+	UIRecordPool() : job(nullptr), jobsize(0), next(0), done(0), stopping(false) {}
+	~UIRecordPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		cv.notify_all();
+		for (std::thread& w : workers) w.join();
+	}
+
+	// calls f(i) once for each i in [0, n), returning once they've all returned
+	void run(size_t n, const std::function<void (size_t)>& f) {
+		std::unique_lock<std::mutex> lock(mutex);
+		job = &f;
+		jobsize = n;
+		next = 0;
+		done = 0;
+		// the calling thread is one of the n
+		const size_t want = std::min<size_t>(n - 1, std::max(std::thread::hardware_concurrency(), 2u) - 1);
+		while (workers.size() < want) workers.emplace_back(&UIRecordPool::work, this);
+		cv.notify_all();
+		take(lock);
+		donecv.wait(lock, [this] () {return done == jobsize;});
+		job = nullptr;
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable cv, donecv;
+	std::vector<std::thread> workers;
+	const std::function<void (size_t)>* job;
+	size_t jobsize, next, done;
+	bool stopping;
+
+	// runs indices of the current job until none are left, unlocking around each
+	void take(std::unique_lock<std::mutex>& lock) {
+		while (job && next < jobsize) {
+			const size_t i = next++;
+			const std::function<void (size_t)>& f = *job;
+			lock.unlock();
+			f(i);
+			lock.lock();
+			if (++done == jobsize) donecv.notify_all();
+		}
+	}
+	void work() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			cv.wait(lock, [this] () {return stopping || (job && next < jobsize);});
+			if (stopping) return;
+			take(lock);
+		}
+	}
+};
+
+static UIRecordPool recordpool;
 
 /* 
  * ---------------
@@ -9,23 +89,24 @@
 // -- Public --
 
 VkExtent2D UIComponent::screenextent = {0, 0};
-UIPipelineInfo UIComponent::defaultgraphicspipeline = {};
 UIImageInfo UIComponent::notex = {};
 VkDescriptorSet UIComponent::defaultds = VK_NULL_HANDLE;
-dfType UIComponent::defaultDrawFunc = nullptr;
+thread_local const UIComponent* UIComponent::drawing = nullptr;
+thread_local UIPushConstantData UIComponent::drawingpcdata = {};
+UIEventStats UIComponent::eventstats = {};
+// everything needs drawing the first frame
+std::vector<UIRect> UIComponent::damagerects = {{{0, 0}, {1e9, 1e9}}};
 
 void swap(UIComponent& c1, UIComponent& c2) {
 	std::swap(c1.pcdata, c2.pcdata);
-	std::swap(c1.graphicspipeline, c2.graphicspipeline);
-	std::swap(c1.drawFunc, c2.drawFunc);
-	std::swap(c1.onHover, c2.onHover);
-	std::swap(c1.onHoverBegin, c2.onHoverBegin);
-	std::swap(c1.onHoverEnd, c2.onHoverEnd);
-	std::swap(c1.onClick, c2.onClick);
-	std::swap(c1.onClickBegin, c2.onClickBegin);
-	std::swap(c1.onClickEnd, c2.onClickEnd);
+	std::swap(c1.style, c2.style);
 	std::swap(c1.ds, c2.ds);
 	std::swap(c1.events, c2.events);
+	// scheduler membership and where they are in the tree stay with the objects
+	const UIDisplayFlags keep = UI_DISPLAY_FLAG_OFFSCREEN | UI_DISPLAY_FLAG_HIDDEN_ANCESTOR;
+	const UIDisplayFlags d1 = c1.display;
+	c1.display = (c2.display & ~keep) | (d1 & keep);
+	c2.display = (d1 & ~keep) | (c2.display & keep);
 }
 
 UIComponent& UIComponent::operator=(UIComponent rhs) {
@@ -34,14 +115,69 @@ UIComponent& UIComponent::operator=(UIComponent rhs) {
 }
 
 void UIComponent::draw(const VkCommandBuffer& cb) const {
+	if (drawSelf(cb)) drawChildren(cb);
+}
+
+void UIComponent::prepareDraw() const {
 	if (display & UI_DISPLAY_FLAG_SHOW) {
-		drawFunc(this, cb);
+		if (display & UI_DISPLAY_FLAG_TEX_PENDING) UIScheduler::genPendingTex(const_cast<UIComponent*>(this));
 		for (const UIComponent* const c : getChildren()) {
-			c->draw(cb);
+			c->frame = childFrame();
+			c->prepareDraw();
 		}
 	}
 }
 
+void UIComponent::collectDrawData(std::vector<UIDrawData>& out) const {
+	if (!(display & UI_DISPLAY_FLAG_SHOW)) return;
+	if (texReady()) {
+		const UIPipelineInfo& p = getGraphicsPipeline();
+		UIPushConstantData abspcdata = pcdata;
+		abspcdata.position = getAbsPos();
+		out.push_back({
+			this,
+			abspcdata,
+			getChrome(),
+			p.pipeline,
+			p.layout,
+			ds,
+			getTexInfo() ? getTexInfo()->image : VK_NULL_HANDLE
+		});
+	}
+	for (const UIComponent* const c : getChildren()) {
+		c->frame = childFrame();
+		c->collectDrawData(out);
+	}
+}
+
+bool UIComponent::drawParallel(
+		const std::vector<const UIComponent*>& roots,
+		const std::vector<VkCommandBuffer>& secondaries,
+		const VkCommandBufferInheritanceInfo& inheritance,
+		const VkCommandBuffer& primary) {
+	if (secondaries.size() < roots.size()) return false;
+	// vkCmdExecuteCommands needs at least one command buffer
+	if (roots.empty()) return true;
+	const VkCommandBufferBeginInfo begininfo {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		nullptr,
+		VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		&inheritance
+	};
+	// texture generation isn't thread-safe (FreeType, texLoadFunc), so get it out of the way first
+	for (const UIComponent* r : roots) r->prepareDraw();
+	// whatever UIScheduler put off waits for the next frame rather than being generated on the workers
+	UIScheduler::recording = true;
+	recordpool.run(roots.size(), [&roots, &secondaries, &begininfo] (size_t i) {
+		vkBeginCommandBuffer(secondaries[i], &begininfo);
+		roots[i]->draw(secondaries[i]);
+		vkEndCommandBuffer(secondaries[i]);
+	});
+	UIScheduler::recording = false;
+	vkCmdExecuteCommands(primary, roots.size(), secondaries.data());
+	return true;
+}
+
 void UIComponent::listenMousePos(UICoord mousepos, void* data) {
 	if (!(display & UI_DISPLAY_FLAG_SHOW)) return;
 	if (mousepos.x > this->getPos().x
@@ -49,133 +185,458 @@ void UIComponent::listenMousePos(UICoord mousepos, void* data) {
 		&& mousepos.x < this->getPos().x + this->getExt().x
 		&& mousepos.y < this->getPos().y + this->getExt().y
 		) {
-		onHover(this, nullptr);
+		styles[style].onHover(this, nullptr);
+		eventstats.hover++;
 		if (!(events & UI_EVENT_FLAG_HOVER)) {
-			onHoverBegin(this, nullptr);
+			styles[style].onHoverBegin(this, nullptr);
+			eventstats.hoverbegin++;
+			damageSelf();
 			events |= UI_EVENT_FLAG_HOVER;
 		}
-		for (UIComponent* c : _getChildren()) c->listenMousePos(mousepos, data);
+		listenChildrenMousePos(mousepos, data);
 	} else if (events & UI_EVENT_FLAG_HOVER) {
-		onHoverEnd(this, nullptr);
+		styles[style].onHoverEnd(this, nullptr);
+		eventstats.hoverend++;
+		damageSelf();
 		events &= ~UI_EVENT_FLAG_HOVER;
-		for (UIComponent* c : _getChildren()) c->listenMousePos(mousepos, data);
+		listenChildrenMousePos(mousepos, data);
 	} 
 	if (display & UI_DISPLAY_FLAG_OVERFLOWING_CHILDREN) {
-		for (UIComponent* c : _getChildren()) c->listenMousePos(mousepos, data);
+		listenChildrenMousePos(mousepos, data);
 	}
 }
 
 void UIComponent::listenMouseClick(bool click, void* data) {
 	if (!(display & UI_DISPLAY_FLAG_SHOW)) return;
 	if ((events & UI_EVENT_FLAG_HOVER) && click) {
-		onClick(this, nullptr);
+		styles[style].onClick(this, nullptr);
+		eventstats.click++;
 		if (!(events & UI_EVENT_FLAG_CLICK)) {
-			onClickBegin(this, nullptr);
+			styles[style].onClickBegin(this, nullptr);
+			eventstats.clickbegin++;
+			damageSelf();
 			events |= UI_EVENT_FLAG_CLICK;
 		}
-		for (UIComponent* c : _getChildren()) c->listenMouseClick(click, data);
+		listenChildrenMouseClick(click, data);
 	} else if (events & UI_EVENT_FLAG_CLICK) {
-		onClickEnd(this, nullptr);
+		styles[style].onClickEnd(this, nullptr);
+		eventstats.clickend++;
+		damageSelf();
 		events &= ~UI_EVENT_FLAG_CLICK;
-		for (UIComponent* c : _getChildren()) c->listenMouseClick(click, data);
+		listenChildrenMouseClick(click, data);
 	} 
 	if (display & UI_DISPLAY_FLAG_OVERFLOWING_CHILDREN) {
-		for (UIComponent* c : _getChildren()) c->listenMouseClick(click, data);
+		listenChildrenMouseClick(click, data);
 	}
 }
 
 void UIComponent::setPos(UICoord p) {
+	if (p == pcdata.position) return;
 	UICoord diff = p - pcdata.position;
+	damageSelf();
 	pcdata.position = p;
-	std::vector<UIComponent*> ctemp = _getChildren();
+	damageSelf();
 	for (UIComponent* c : _getChildren()) c->setPos(c->getPos() + diff);
 }
 
+UICoord UIComponent::getAbsPos() const {
+	UICoord result = pcdata.position;
+	const UIContainer* c;
+	for (uint32_t f = frame; f != UI_SCREEN_FRAME && (c = UIContainer::frames[f]); f = c->frame) {
+		result += c->pcdata.position - c->scroll;
+	}
+	return result;
+}
+
+void UIComponent::setExt(UICoord e) {
+	if (e == pcdata.extent) return;
+	damageSelf();
+	pcdata.extent = e;
+	damageSelf();
+}
+
+void UIComponent::setBGCol(UIColor c) {
+	if (c.r == pcdata.bgcolor.r && c.g == pcdata.bgcolor.g && c.b == pcdata.bgcolor.b && c.a == pcdata.bgcolor.a) return;
+	pcdata.bgcolor = c;
+	damageSelf();
+}
+
+void UIComponent::setCornerRadius(float r) {
+	writableStyle().chrome.cornerradius = r;
+	damageSelf();
+}
+
+void UIComponent::setChrome(const UIChromeData& c) {
+	damageSelf();
+	writableStyle().chrome = c;
+	damageSelf();
+}
+
 void UIComponent::setGraphicsPipeline(const UIPipelineInfo& p) {
-	graphicspipeline = p;
+	const UIPipelineInfo& current = getGraphicsPipeline();
+	if (current.pipeline != p.pipeline || current.layout != p.layout || current.dsl != p.dsl) {
+		std::pair<UIStyleHandle, VkPipeline> key(style, p.pipeline);
+		auto derived = pipelinestyles.find(key);
+		if (derived == pipelinestyles.end()
+			|| styles[derived->second].graphicspipeline.layout != p.layout
+			|| styles[derived->second].graphicspipeline.dsl != p.dsl) {
+			UIStyleHandle h = allocStyle(styles[style]);
+			styles[h].graphicspipeline = p;
+			pipelinestyles[key] = h;
+			setStyle(h);
+		}
+		else setStyle(derived->second);
+	}
 	for (UIComponent* c : _getChildren()) c->setGraphicsPipeline(p);
 }
 
+UIStyleHandle UIComponent::createStyle(const UIStyle& s) {
+	UIStyleHandle h = allocStyle(s);
+	styleusers[h] = 1;
+	return h;
+}
+
+void UIComponent::setStyle(UIStyleHandle h) {
+	if (h == style) return;
+	// only overwrite bgcolor if the style actually changes it, so pipeline/callback overrides keep setBGCol
+	const UIColor& oldcol = styles[style].bgcolor, newcol = styles[h].bgcolor;
+	if (oldcol.r != newcol.r || oldcol.g != newcol.g || oldcol.b != newcol.b || oldcol.a != newcol.a) {
+		pcdata.bgcolor = newcol;
+	}
+	acquireStyle(h);
+	releaseStyle(style);
+	style = h;
+	damageSelf();
+}
+
+void UIComponent::setBorder(float w, UIColor c) {
+	UIChromeData& chrome = writableStyle().chrome;
+	chrome.borderwidth = w;
+	chrome.bordercolor = c;
+	damageSelf();
+}
+
+void UIComponent::setShadow(UICoord offset, float blur, UIColor c) {
+	damageSelf();
+	UIChromeData& chrome = writableStyle().chrome;
+	chrome.shadowoffset = offset;
+	chrome.shadowblur = blur;
+	chrome.shadowcolor = c;
+	damageSelf();
+}
+
+std::vector<UIRect> UIComponent::takeDamage() {
+	std::vector<UIRect> result;
+	std::swap(result, damagerects);
+	// in case anything was damaged before the screen extent was known
+	for (UIRect& r : result) r = clipToScreen(r);
+	std::erase_if(result, [] (const UIRect& r) {return r.empty();});
+	return result;
+}
+
+void UIComponent::addDamage(UIRect r) {
+	r = clipToScreen(r);
+	if (r.empty()) return;
+	// absorb anything r touches, which may make r touch something it didn't before
+	for (size_t i = 0; i < damagerects.size();) {
+		if (damagerects[i].overlaps(r)) {
+			r = r.merge(damagerects[i]);
+			damagerects[i] = damagerects.back();
+			damagerects.pop_back();
+			i = 0;
+		}
+		else i++;
+	}
+	damagerects.push_back(r);
+	if (damagerects.size() > UI_MAX_DAMAGE_RECTS) {
+		for (size_t i = 1; i < damagerects.size(); i++) damagerects[0] = damagerects[0].merge(damagerects[i]);
+		damagerects.resize(1);
+	}
+}
+
+UIRect UIComponent::clipToScreen(UIRect r) {
+	if (!screenextent.width || !screenextent.height) return r;
+	const UICoord lo(std::max(r.position.x, 0.f), std::max(r.position.y, 0.f)),
+		hi(std::min(r.position.x + r.extent.x, (float)screenextent.width),
+			std::min(r.position.y + r.extent.y, (float)screenextent.height));
+	return {lo, hi - lo};
+}
+
+// region a quad at absolute position p can touch, including its shadow
+static UIRect chromeRect(UICoord p, UICoord e, const UIChromeData& chrome) {
+	if (chrome.shadowcolor.a <= 0) return {p, e};
+	const UICoord margin(
+		chrome.shadowblur + fabsf(chrome.shadowoffset.x),
+		chrome.shadowblur + fabsf(chrome.shadowoffset.y));
+	return {p - margin, e + margin * 2};
+}
+
+UIRect UIComponent::getDrawRect() const {
+	return chromeRect(getAbsPos(), pcdata.extent, getChrome());
+}
+
+UIRect UIComponent::getDrawRect(const UIDrawData& d) {
+	return chromeRect(d.pcdata.position, d.pcdata.extent, d.chrome);
+}
+
 void UIComponent::show() {
 	// should technically re-listen for mousepos & click
+	if (display & UI_DISPLAY_FLAG_SHOW) return;
 	setDisplayFlag(UI_DISPLAY_FLAG_SHOW);
+	damageShown();
 }
 
 void UIComponent::hide() {
+	damageShown();
 	unsetDisplayFlag(UI_DISPLAY_FLAG_SHOW);
 	if (events & UI_EVENT_FLAG_HOVER) {
 		events &= ~UI_EVENT_FLAG_HOVER;
-		onHoverEnd(this, nullptr);
+		styles[style].onHoverEnd(this, nullptr);
+		eventstats.hoverend++;
 	}
 	if (events & UI_EVENT_FLAG_CLICK) {
 		events &= ~UI_EVENT_FLAG_CLICK;
-		onClickEnd(this, nullptr);
+		styles[style].onClickEnd(this, nullptr);
+		eventstats.clickend++;
 	}
 }
 
 // -- Protected --
 
+void UIComponent::damageShown() {
+	if (!(display & UI_DISPLAY_FLAG_SHOW)) return;
+	damageSelf();
+	for (UIComponent* c : _getChildren()) c->damageShown();
+}
+
+void UIComponent::damageSelf() {
+	if (!(display & UI_DISPLAY_FLAG_SHOW)) return;
+	const UIRect d = getDrawRect();
+	addDamage(d);
+	// this may have grown the bounds of the containers it's in
+	UIContainer::growBounds(frame, d);
+}
+
+void UIComponent::adopt(UIComponent* c) const {
+	c->frame = childFrame();
+	if (!(c->display & UI_DISPLAY_FLAG_HIDDEN_ANCESTOR) != shownInTree()) {
+		c->display ^= UI_DISPLAY_FLAG_HIDDEN_ANCESTOR;
+		c->shownChanged();
+	}
+	for (UIComponent* gc : c->_getChildren()) c->adopt(gc);
+}
+
+void UIComponent::propagateShown() {
+	const bool shown = shownInTree();
+	for (UIComponent* c : _getChildren()) {
+		if (!(c->display & UI_DISPLAY_FLAG_HIDDEN_ANCESTOR) == shown) continue;
+		c->display ^= UI_DISPLAY_FLAG_HIDDEN_ANCESTOR;
+		c->shownChanged();
+		// a hidden child hides its descendants either way
+		if (c->display & UI_DISPLAY_FLAG_SHOW) c->propagateShown();
+	}
+}
+
+bool UIComponent::drawSelf(const VkCommandBuffer& cb) const {
+	if (!(display & UI_DISPLAY_FLAG_SHOW)) return false;
+	// put off by UIScheduler with nothing to show meanwhile, children are still drawn
+	if (!texReady()) return true;
+	markDrawn();
+	if (frame == UI_SCREEN_FRAME) styles[style].drawFunc(this, cb);
+	else {
+		// drawFuncs push getPCData as is, so it has the absolute position just for the call, and any component
+		// drawn from within the call gets its own
+		const UIComponent* const outer = drawing;
+		const UIPushConstantData outerpcdata = drawingpcdata;
+		drawingpcdata = pcdata;
+		drawingpcdata.position = getAbsPos();
+		drawing = this;
+		try {
+			styles[style].drawFunc(this, cb);
+		}
+		catch (...) {
+			drawing = outer;
+			drawingpcdata = outerpcdata;
+			throw;
+		}
+		drawing = outer;
+		drawingpcdata = outerpcdata;
+	}
+	return true;
+}
+
+void UIComponent::drawChildren(const VkCommandBuffer& cb) const {
+	for (const UIComponent* const c : getChildren()) {
+		c->frame = childFrame();
+		c->draw(cb);
+	}
+}
+
+void UIComponent::listenChildrenMousePos(UICoord mousepos, void* data) {
+	for (UIComponent* c : _getChildren()) c->listenMousePos(mousepos, data);
+}
+
+void UIComponent::listenChildrenMouseClick(bool click, void* data) {
+	for (UIComponent* c : _getChildren()) c->listenMouseClick(click, data);
+}
+
 // TODO: double-check this impl
 UIComponent::UIComponent(UIComponent&& rhs) noexcept :
 		pcdata(rhs.pcdata),
-		graphicspipeline(defaultgraphicspipeline),
-		drawFunc(rhs.drawFunc),
-		onHover(rhs.onHover),
-		onHoverBegin(rhs.onHoverBegin),
-		onHoverEnd(rhs.onHoverEnd),
-		onClick(rhs.onClick),
-		onClickBegin(rhs.onClickBegin),
-		onClickEnd(rhs.onClickEnd),
-		ds(rhs.ds),
+		display(rhs.display & ~(UI_DISPLAY_FLAG_OFFSCREEN | UI_DISPLAY_FLAG_HIDDEN_ANCESTOR)),
 		events(rhs.events),
-		display(rhs.display) {
+		ds(rhs.ds),
+		style(rhs.style),
+		frame(rhs.frame) {
 	// TODO: figure out if this body is neccesary
 	// TODO: figure out if list init should use std::move
 	rhs.pcdata = (UIPushConstantData){};
-	rhs.drawFunc = nullptr;
-	rhs.onHover = nullptr;
-	rhs.onHoverBegin = nullptr;
-	rhs.onHoverEnd = nullptr;
-	rhs.onClick = nullptr;
-	rhs.onClickBegin = nullptr;
-	rhs.onClickEnd = nullptr;
+	rhs.style = UI_DEFAULT_STYLE;
 	rhs.ds = VK_NULL_HANDLE;
 	rhs.events = UI_EVENT_FLAG_NONE;
-	rhs.display = UI_DISPLAY_FLAG_SHOW;
+	rhs.display = UI_DISPLAY_FLAG_SHOW | (rhs.display & (UI_DISPLAY_FLAG_OFFSCREEN | UI_DISPLAY_FLAG_HIDDEN_ANCESTOR));
+}
+
+UIComponent::~UIComponent() {
+	if (display & UI_DISPLAY_FLAG_OFFSCREEN) UIScheduler::forget(this);
+	damageSelf();
+	releaseStyle(style);
 }
 
 // -- Private --
 
 cfType UIComponent::defaultOnHover = [] (UIComponent* self, void* d) {};
 cfType UIComponent::defaultOnHoverBegin = [] (UIComponent* self, void* d) {
-	self->pcdata.bgcolor = UI_DEFAULT_HOVER_BG_COLOR;
+	self->setBGCol(self->getStyle().hoverbgcolor);
 };
 cfType UIComponent::defaultOnHoverEnd = [] (UIComponent* self, void* d) {
-	self->pcdata.bgcolor = UI_DEFAULT_BG_COLOR;
+	self->setBGCol(self->getStyle().bgcolor);
 };
 cfType UIComponent::defaultOnClick = [] (UIComponent* self, void* d) {};
 cfType UIComponent::defaultOnClickBegin = [] (UIComponent* self, void* d) {
-	self->pcdata.bgcolor = UI_DEFAULT_CLICK_BG_COLOR;
+	self->setBGCol(self->getStyle().clickbgcolor);
 };
 cfType UIComponent::defaultOnClickEnd = [] (UIComponent* self, void* d) {
-	self->pcdata.bgcolor = UI_DEFAULT_BG_COLOR;
+	self->setBGCol(self->getStyle().bgcolor);
 };
 
+// must come after the default callbacks, as the default style is built from them
+std::deque<UIStyle> UIComponent::styles = {(UIStyle){
+	.drawFunc = nullptr,
+	.onHover = defaultOnHover,
+	.onHoverBegin = defaultOnHoverBegin,
+	.onHoverEnd = defaultOnHoverEnd,
+	.onClick = defaultOnClick,
+	.onClickBegin = defaultOnClickBegin,
+	.onClickEnd = defaultOnClickEnd
+}};
+std::vector<uint32_t> UIComponent::styleusers = {1};
+std::vector<UIStyleHandle> UIComponent::freestyles = {};
+std::map<std::pair<UIStyleHandle, VkPipeline>, UIStyleHandle> UIComponent::pipelinestyles = {};
+
+// new styles start with no users
+UIStyleHandle UIComponent::allocStyle(const UIStyle& s) {
+	if (freestyles.empty()) {
+		styles.push_back(s);
+		styleusers.push_back(0);
+		return styles.size() - 1;
+	}
+	UIStyleHandle h = freestyles.back();
+	freestyles.pop_back();
+	styles[h] = s;
+	styleusers[h] = 0;
+	return h;
+}
+
+// UI_DEFAULT_STYLE is never freed, so it isn't counted
+UIStyleHandle UIComponent::acquireStyle(UIStyleHandle h) {
+	if (h != UI_DEFAULT_STYLE) styleusers[h]++;
+	return h;
+}
+
+void UIComponent::releaseStyle(UIStyleHandle h) {
+	if (h == UI_DEFAULT_STYLE || --styleusers[h] != 0) return;
+	forgetDerivedStyle(h);
+	styles[h] = UIStyle();
+	freestyles.push_back(h);
+}
+
+void UIComponent::forgetDerivedStyle(UIStyleHandle h) {
+	for (auto i = pipelinestyles.begin(); i != pipelinestyles.end();) {
+		if (i->first.first == h || i->second == h) i = pipelinestyles.erase(i);
+		else i++;
+	}
+}
+
+bool UIComponent::texReady() const {
+	// lazily generated textures are a cache, so this doesn't change anything observable
+	if (!(display & UI_DISPLAY_FLAG_TEX_PENDING) || UIScheduler::genPendingTex(const_cast<UIComponent*>(this))) {
+		return true;
+	}
+	// an old texture or placeholder can stand in until the new one's made
+	if (!staleTexDrawable()) return false;
+	const UIImageInfo* t = getTexInfo();
+	return !t || t->image != VK_NULL_HANDLE;
+}
+
+UIStyle& UIComponent::writableStyle() {
+	if (style == UI_DEFAULT_STYLE || styleusers[style] > 1) setStyle(allocStyle(styles[style]));
+	// a style we're about to change in place can't keep standing in for an interned pipeline override
+	else forgetDerivedStyle(style);
+	return styles[style];
+}
+
 /*
  * ---------------
  * | UIContainer |
  * ---------------
  */
 
+std::vector<const UIContainer*> UIContainer::frames = {nullptr};
+std::vector<uint32_t> UIContainer::freeframes = {};
+
 // -- Public --
 
+UIContainer::UIContainer() :
+		UIComponent(),
+		scroll(0, 0),
+		frameid(allocFrame(this)),
+		contentbounds({}),
+		boundsdirty(true),
+		children({}),
+		copiers({}) {}
+
+UIContainer::UIContainer(const UIContainer& rhs) :
+		UIComponent(rhs),
+		scroll(rhs.scroll),
+		frameid(allocFrame(this)),
+		contentbounds({}),
+		boundsdirty(true),
+		children({}),
+		copiers(rhs.copiers) {
+	// the children are owned, so they're copied rather than shared
+	for (size_t i = 0; i < rhs.children.size(); i++) {
+		children.push_back(copiers[i](rhs.children[i]));
+		adopt(children.back());
+	}
+}
+
 UIContainer::~UIContainer() {
 	for (UIComponent* c : children) delete c;
+	frames[frameid] = nullptr;
+	freeframes.push_back(frameid);
 }
 
 void swap(UIContainer& c1, UIContainer& c2) {
 	swap(static_cast<UIComponent&>(c1), static_cast<UIComponent&>(c2));
 	std::swap(c1.children, c2.children);
+	std::swap(c1.copiers, c2.copiers);
+	std::swap(c1.scroll, c2.scroll);
+	// frame ids stay with the objects, so the children have to follow
+	for (UIComponent* c : c1.children) c1.adopt(c);
+	for (UIComponent* c : c2.children) c2.adopt(c);
+	c1.boundsdirty = true;
+	c2.boundsdirty = true;
 }
 
 UIContainer& UIContainer::operator=(UIContainer rhs) {
@@ -189,12 +650,345 @@ std::vector<const UIComponent*> UIContainer::getChildren() const {
 	return result;
 }
 
+void UIContainer::setPos(UICoord p) {
+	if (p == pcdata.position) return;
+	damageContent();
+	damageSelf();
+	pcdata.position = p;
+	damageSelf();
+	damageContent();
+}
+
+void UIContainer::setScroll(UICoord s) {
+	if (s == scroll) return;
+	damageContent();
+	scroll = s;
+	damageContent();
+}
+
 // -- Private --
 
 std::vector<UIComponent*> UIContainer::_getChildren() {
 	return children;
 }
 
+void UIContainer::drawChildren(const VkCommandBuffer& cb) const {
+	for (const UIComponent* const c : children) c->draw(cb);
+}
+
+void UIContainer::listenChildrenMousePos(UICoord mousepos, void* data) {
+	mousepos -= pcdata.position - scroll;
+	for (UIComponent* c : children) c->listenMousePos(mousepos, data);
+}
+
+void UIContainer::listenChildrenMouseClick(bool click, void* data) {
+	for (UIComponent* c : children) c->listenMouseClick(click, data);
+}
+
+const UIRect& UIContainer::getContentBounds() const {
+	if (boundsdirty) {
+		contentbounds = {};
+		for (const UIComponent* c : children) accumulateBounds(c, contentbounds);
+		contentbounds.position -= getChildOrigin();
+		boundsdirty = false;
+	}
+	return contentbounds;
+}
+
+void UIContainer::damageContent() const {
+	if (!(display & UI_DISPLAY_FLAG_SHOW)) return;
+	const UIRect& b = getContentBounds();
+	if (b.empty()) return;
+	const UIRect d = {b.position + getChildOrigin(), b.extent};
+	addDamage(d);
+	// moving or scrolling this moves its content within its ancestors
+	growBounds(frame, d);
+}
+
+uint32_t UIContainer::allocFrame(const UIContainer* c) {
+	if (freeframes.empty()) {
+		frames.push_back(c);
+		return frames.size() - 1;
+	}
+	const uint32_t result = freeframes.back();
+	freeframes.pop_back();
+	frames[result] = c;
+	return result;
+}
+
+void UIContainer::accumulateBounds(const UIComponent* c, UIRect& r) {
+	if (!(c->display & UI_DISPLAY_FLAG_SHOW)) return;
+	const UIRect d = c->getDrawRect();
+	if (!d.empty()) r = r.empty() ? d : r.merge(d);
+	// a nested container's bounds already cover its subtree
+	const uint32_t f = c->childFrame();
+	if (f != c->frame && frames[f] == c) {
+		const UIContainer* cc = frames[f];
+		const UIRect& b = cc->getContentBounds();
+		if (!b.empty()) {
+			const UIRect a = {b.position + cc->getChildOrigin(), b.extent};
+			r = r.empty() ? a : r.merge(a);
+		}
+		return;
+	}
+	for (const UIComponent* gc : c->getChildren()) accumulateBounds(gc, r);
+}
+
+void UIContainer::growBounds(uint32_t f, const UIRect& r) {
+	if (r.empty()) return;
+	const UIContainer* c;
+	for (; f != UI_SCREEN_FRAME && (c = frames[f]); f = c->frame) {
+		// a dirty container will recompute, but the ones above it still have to grow
+		if (c->boundsdirty) continue;
+		const UIRect rel = {r.position - c->getChildOrigin(), r.extent};
+		// every clean ancestor covers what this one does, so they all cover r already
+		if (c->contentbounds.contains(rel)) return;
+		c->contentbounds = c->contentbounds.empty() ? rel : c->contentbounds.merge(rel);
+	}
+}
+
+/*
+ * -----------------
+ * | UIImageLoader |
+ * -----------------
+ */
+
+typedef struct UIDecodedImage {
+	VkExtent2D extent;
+	VkFormat format; // of pixels, which may be block-compressed
+	std::vector<unorm> pixels;
+	bool ok;
+} UIDecodedImage;
+
+static bool decodePNGFile(const std::string& path, std::vector<unorm>& pixels, VkExtent2D& e) {
+	FILE* f = fopen(path.c_str(), "rb");
+	if (!f) return false;
+	std::vector<unorm> data;
+	unorm buf[16384];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+	fclose(f);
+	return UIDecodePNG(data.data(), data.size(), pixels, e.width, e.height);
+}
+
+/*
+ * Worker threads decoding image files for UIImage::setSource, and the cache of their results. Only
+ * UIImage's statics use it, all on the owning thread; workers never touch components.
+ */
+class UIImageLoader {
+public:
+	UIImageLoader() :
+		decodefunc(decodePNGFile),
+		compress(false),
+		compressmin(0),
+		encodems(0),
+		cachebytes(0),
+		cachelimit(UI_DEFAULT_DECODE_CACHE_LIMIT),
+		stopping(false),
+		stats({}) {}
+	~UIImageLoader() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		cv.notify_all();
+		for (std::thread& w : workers) w.join();
+	}
+
+	// the decoded image if there is one, otherwise queues path for decoding (once) and returns nullptr
+	std::shared_ptr<const UIDecodedImage> request(const std::string& path) {
+		std::lock_guard<std::mutex> lock(mutex);
+		auto cached = cache.find(path);
+		if (cached != cache.end()) {
+			stats.cachehits++;
+			touch(cached->second);
+			return cached->second.image;
+		}
+		if (inflight.insert(path).second) {
+			jobs.push_back(path);
+			if (workers.empty()) {
+				const uint32_t n = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+				for (uint32_t i = 0; i < n; i++) workers.emplace_back(&UIImageLoader::work, this);
+			}
+			cv.notify_one();
+		}
+		return nullptr;
+	}
+	std::shared_ptr<const UIDecodedImage> find(const std::string& path) {
+		std::lock_guard<std::mutex> lock(mutex);
+		auto cached = cache.find(path);
+		if (cached == cache.end()) return nullptr;
+		touch(cached->second);
+		return cached->second.image;
+	}
+	// paths decoded since the last call
+	std::vector<std::string> takeFinished() {
+		std::lock_guard<std::mutex> lock(mutex);
+		std::vector<std::string> result;
+		result.swap(finished);
+		return result;
+	}
+	void clear() {
+		std::lock_guard<std::mutex> lock(mutex);
+		cache.clear();
+		lru.clear();
+		pinned.clear();
+		cachebytes = 0;
+	}
+	// path's decode has been uploaded for the components that were waiting on it, so it can be evicted
+	void unpin(const std::string& path) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (pinned.erase(path)) evict();
+	}
+	void setCacheLimit(size_t bytes) {
+		std::lock_guard<std::mutex> lock(mutex);
+		cachelimit = bytes;
+		evict();
+	}
+	void setDecodeFunc(idfType f) {
+		std::lock_guard<std::mutex> lock(mutex);
+		decodefunc = f;
+	}
+	// for decodes started after this
+	void setCompression(bool c, uint32_t mintexels) {
+		std::lock_guard<std::mutex> lock(mutex);
+		compress = c;
+		compressmin = mintexels;
+	}
+	UILoadStats getStats() {
+		std::lock_guard<std::mutex> lock(mutex);
+		UILoadStats result = stats;
+		result.queued = inflight.size();
+		result.cachebytes = cachebytes;
+		return result;
+	}
+	double getEncodeMs() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return encodems;
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::vector<std::thread> workers;
+	std::deque<std::string> jobs;
+	std::unordered_set<std::string> inflight;
+	std::vector<std::string> finished;
+	typedef struct CacheEntry {
+		std::shared_ptr<const UIDecodedImage> image;
+		std::list<std::string>::iterator lru;
+	} CacheEntry;
+	std::unordered_map<std::string, CacheEntry> cache;
+	// cached paths, least recently used first
+	std::list<std::string> lru;
+	// finished decodes not yet uploaded, which evict keeps so their waiters don't decode them again
+	std::unordered_set<std::string> pinned;
+	idfType decodefunc;
+	bool compress;
+	uint32_t compressmin;
+	double encodems;
+	size_t cachebytes, cachelimit;
+	bool stopping;
+	UILoadStats stats;
+
+	static size_t entryBytes(const std::string& path, const UIDecodedImage& d) {
+		return sizeof(CacheEntry) + sizeof(UIDecodedImage) + path.size() * 2 + d.pixels.size();
+	}
+	void touch(CacheEntry& e) {lru.splice(lru.end(), lru, e.lru);}
+	// drops least recently used entries until the cache fits, except pinned ones and the newest
+	void evict() {
+		for (auto p = lru.begin(); cachebytes > cachelimit && lru.size() > 1 && p != std::prev(lru.end());) {
+			if (pinned.contains(*p)) {
+				p++;
+				continue;
+			}
+			auto e = cache.find(*p);
+			cachebytes -= entryBytes(e->first, *e->second.image);
+			cache.erase(e);
+			p = lru.erase(p);
+			stats.cacheevictions++;
+		}
+	}
+	void insert(const std::string& path, std::shared_ptr<const UIDecodedImage> d) {
+		auto old = cache.find(path);
+		if (old != cache.end()) {
+			cachebytes -= entryBytes(path, *old->second.image);
+			lru.erase(old->second.lru);
+			cache.erase(old);
+		}
+		cachebytes += entryBytes(path, *d);
+		lru.push_back(path);
+		cache[path] = {std::move(d), std::prev(lru.end())};
+		evict();
+	}
+
+	void work() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			cv.wait(lock, [this] () {return stopping || !jobs.empty();});
+			if (stopping) return;
+			const std::string path = std::move(jobs.front());
+			jobs.pop_front();
+			idfType f = decodefunc;
+			const bool c = compress;
+			const uint32_t cmin = compressmin;
+			lock.unlock();
+			std::shared_ptr<UIDecodedImage> d = std::make_shared<UIDecodedImage>();
+			d->extent = {0, 0};
+			d->format = VK_FORMAT_R8G8B8A8_UNORM;
+			double ms = 0;
+			try {
+				d->ok = f(path, d->pixels, d->extent)
+					&& d->extent.width && d->extent.height
+					&& d->pixels.size() >= (size_t)d->extent.width * d->extent.height * 4;
+			}
+			catch (...) {
+				// e.g., std::bad_alloc for a corrupt or huge file, which would otherwise end the process
+				d->ok = false;
+			}
+			if (!d->ok) {
+				d->pixels.clear();
+				d->pixels.shrink_to_fit();
+			}
+			else {
+				// textures start bottom left, like UICoord
+				const size_t stride = (size_t)d->extent.width * 4;
+				for (uint32_t y = 0; y < d->extent.height / 2; y++) {
+					std::swap_ranges(
+						d->pixels.begin() + y * stride,
+						d->pixels.begin() + (y + 1) * stride,
+						d->pixels.begin() + (d->extent.height - 1 - y) * stride);
+				}
+				if (c && (size_t)d->extent.width * d->extent.height >= cmin) {
+					const auto start = std::chrono::steady_clock::now();
+					bool opaque = true;
+					for (size_t i = 3; i < d->pixels.size() && opaque; i += 4) opaque = d->pixels[i] == 255;
+					if (opaque) {
+						d->pixels = UIEncodeBC1(d->pixels.data(), d->extent.width, d->extent.height);
+						d->format = VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+					}
+					else {
+						d->pixels = UIEncodeBC3(d->pixels.data(), d->extent.width, d->extent.height);
+						d->format = VK_FORMAT_BC3_UNORM_BLOCK;
+					}
+					ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				}
+			}
+			lock.lock();
+			encodems += ms;
+			// failures are cached too, so they aren't retried every frame
+			pinned.insert(path);
+			insert(path, d);
+			inflight.erase(path);
+			finished.push_back(path);
+			if (d->ok) stats.decoded++;
+			else stats.failed++;
+		}
+	}
+};
+
+static UIImageLoader imageloader;
+
 /*
  * -----------
  * | UIImage |
@@ -203,11 +997,28 @@ std::vector<UIComponent*> UIContainer::_getChildren() {
 
 tfType UIImage::texLoadFunc = nullptr; 
 tdfType UIImage::texDestroyFunc = nullptr;
-std::map<VkImage, uint8_t> UIImage::imgusers = {};
+tufType UIImage::texUpdateFunc = nullptr;
+std::map<VkImage, uint32_t> UIImage::imgusers = {};
+std::map<VkImage, VkDeviceSize> UIImage::imgbytes = {};
+std::set<std::pair<uint64_t, UIImage*>> UIImage::evictable = {};
+std::atomic<uint64_t> UIImage::drawclock = 0;
+VkDeviceSize UIImage::texbudget = 0;
+VkDeviceSize UIImage::residentbytes = 0;
+uint64_t UIImage::evictions = 0;
+std::unordered_map<std::string, UIImageInfo> UIImage::sourcetex = {};
+std::unordered_map<VkImage, std::string> UIImage::sourcetexpaths = {};
+std::unordered_map<std::string, std::vector<UIImage*>> UIImage::loadwaiters = {};
+std::deque<std::string> UIImage::loadready = {};
+uint64_t UIImage::loaduploads = 0;
+UITexCompressFlags UIImage::texcompress = UI_TEX_COMPRESS_NONE;
+uint32_t UIImage::texcompressmin = 0;
+UITexCompressStats UIImage::compressstats = {};
+uint64_t UIImage::texloads = 0;
+uint64_t UIImage::texupdates = 0;
 
 // -- Public --
 
-UIImage::UIImage() : UIComponent() {
+UIImage::UIImage() : UIComponent(), lastdrawn(0), evictkey(UINT64_MAX) {
 	pcdata.flags |= UI_PC_FLAG_TEX;
 #ifdef VERBOSE_IMAGE_OBJECTS
 	std::cout << "UIImage()" << std::endl;
@@ -215,55 +1026,69 @@ UIImage::UIImage() : UIComponent() {
 }
 
 UIImage::UIImage(const UIImage& rhs) :
-		tex(rhs.tex),
-		UIComponent(rhs) {
-	if (tex.image != VK_NULL_HANDLE && tex.image != UIComponent::getNoTex().image) {
-		if (imgusers.contains(tex.image)) imgusers[tex.image]++;
-		else imgusers[tex.image] = 1;
-	}
+		UIComponent(rhs),
+		lastdrawn(rhs.lastdrawn),
+		evictkey(UINT64_MAX),
+		source(rhs.source) {
+	acquireTex(rhs.tex);
+	tex = rhs.tex;
+	updateEvictable();
+	resumeWaiting();
 #ifdef VERBOSE_IMAGE_OBJECTS
 	std::cout << "UIImage(const UIImage&)\n";
 	if (tex.image == VK_NULL_HANDLE) std::cout << "null img" << std::endl;
-	else std::cout << (int)imgusers[tex.image] << " users of " << tex.image << std::endl;
+	else std::cout << imgusers[tex.image] << " users of " << tex.image << std::endl;
 #endif
 }
 
 UIImage::UIImage(UIImage&& rhs) noexcept :
+	UIComponent(rhs),
 	tex(std::move(rhs.tex)),
-	UIComponent(rhs) {
+	lastdrawn(rhs.lastdrawn),
+	evictkey(UINT64_MAX),
+	source(rhs.source) {
+	// rhs's reference now belongs to us
+	rhs.tex = UIImageInfo();
+	rhs.updateEvictable();
+	updateEvictable();
+	resumeWaiting();
 #ifdef VERBOSE_IMAGE_OBJECTS
 	std::cout << "UIImage(UIImage&&)\n";
 	if (tex.image == VK_NULL_HANDLE) std::cout << "null img" << std::endl;
-	else std::cout << (int)imgusers[tex.image] << " users of " << tex.image << std::endl;
+	else std::cout << imgusers[tex.image] << " users of " << tex.image << std::endl;
 #endif
 }
 
-UIImage::UIImage(UICoord p) : UIComponent(p, UICoord{0, 0}) {
-	UIImage();
+UIImage::UIImage(UICoord p) : UIComponent(p, UICoord{0, 0}), lastdrawn(0), evictkey(UINT64_MAX) {
+	pcdata.flags |= UI_PC_FLAG_TEX;
 #ifdef VERBOSE_IMAGE_OBJECTS
 	std::cout << "UIImage(UICoord)\n";
-	std::cout << (int)imgusers[tex.image] << " users of " << tex.image << std::endl;
+	std::cout << imgusers[tex.image] << " users of " << tex.image << std::endl;
 #endif
 }
 
 UIImage::~UIImage() {
-	if (tex.image != VK_NULL_HANDLE && tex.image != UIComponent::getNoTex().image) {
-		if (imgusers[tex.image] == 1) {
-			texDestroyFunc(this);
-			imgusers.erase(tex.image);
-		}
-		else imgusers[tex.image]--;
-	}
+	if (evictkey != UINT64_MAX) evictable.erase({evictkey, this});
+	stopWaiting();
+	releaseTex();
 #ifdef VERBOSE_IMAGE_OBJECTS
 	std::cout << "~UIImage()\n";
 	if (tex.image == VK_NULL_HANDLE) std::cout << "null img" << std::endl;
-	else std::cout << (int)imgusers[tex.image] << " users of " << tex.image << std::endl;
+	else std::cout << imgusers[tex.image] << " users of " << tex.image << std::endl;
 #endif
 }
 
 void swap(UIImage& t1, UIImage& t2) {
+	t1.stopWaiting();
+	t2.stopWaiting();
 	swap(static_cast<UIComponent&>(t1), static_cast<UIComponent&>(t2));
 	std::swap(t1.tex, t2.tex);
+	std::swap(t1.lastdrawn, t2.lastdrawn);
+	std::swap(t1.source, t2.source);
+	t1.updateEvictable();
+	t2.updateEvictable();
+	t1.resumeWaiting();
+	t2.resumeWaiting();
 }
 
 UIImage& UIImage::operator=(UIImage rhs) {
@@ -271,37 +1096,275 @@ UIImage& UIImage::operator=(UIImage rhs) {
 #ifdef VERBOSE_IMAGE_OBJECTS
 	std::cout << "Image& = Image\n";
 	if (tex.image == VK_NULL_HANDLE) std::cout << "null img" << std::endl;
-	else std::cout << (int)imgusers[tex.image] << " users of " << tex.image << std::endl;
+	else std::cout << imgusers[tex.image] << " users of " << tex.image << std::endl;
 #endif
 	return *this;
 }
 
 void UIImage::setTex(const UIImageInfo& i) {
 	if (tex.image != i.image) {
-		if (tex.image != VK_NULL_HANDLE && tex.image != UIComponent::getNoTex().image) {
-			if (imgusers[tex.image] == 1) {
-				imgusers.erase(tex.image);
-				texDestroyFunc(this);
-			}
-			else imgusers[tex.image]--;
-		}
-		if (i.image != VK_NULL_HANDLE && i.image != UIComponent::getNoTex().image) {
-			if (imgusers.contains(i.image)) imgusers[i.image]++;
-			else imgusers[i.image] = 1;
-		}
+		releaseTex();
+		acquireTex(i);
+		setTexRegion({0, 0});
+		damageSelf();
 	}
 #ifdef VERBOSE_IMAGE_OBJECTS
 	std::cout << "setTex\n";
 	if (tex.image == VK_NULL_HANDLE) std::cout << "null img" << std::endl;
-	else std::cout << (int)imgusers[tex.image] << " users of " << tex.image << std::endl;
+	else std::cout << imgusers[tex.image] << " users of " << tex.image << std::endl;
 	if (i.image == VK_NULL_HANDLE) std::cout << "null img" << std::endl;
-	else std::cout << (int)imgusers[i.image] << " users of " << i.image << std::endl;
+	else std::cout << imgusers[i.image] << " users of " << i.image << std::endl;
 #endif
 	tex = i;
+	updateEvictable();
+}
+
+void UIImage::enforceTexBudget() {
+	if (texbudget == 0) return;
+	// evictTex takes each out of evictable, a shared texture is freed once its last user is evicted
+	while (residentbytes > texbudget && !evictable.empty()) evictable.begin()->second->evictTex();
+}
+
+UITexStats UIImage::getTexStats() {
+	return {residentbytes, texbudget, (uint32_t)imgbytes.size(), evictions, texloads, texupdates};
+}
+
+VkExtent2D UIImage::getTexRegion(const UIPushConstantData& pc) {
+	return {
+		pc.flags >> UI_PC_TEX_REGION_SHIFT & UI_PC_TEX_REGION_MAX,
+		pc.flags >> (UI_PC_TEX_REGION_SHIFT + UI_PC_TEX_REGION_BITS) & UI_PC_TEX_REGION_MAX
+	};
+}
+
+void UIImage::setSource(std::string path) {
+	if (path == source && (loaded() || loadwaiters.contains(source))) return;
+	stopWaiting();
+	source = path;
+	setTex(UIComponent::getNoTex());
+	damageSelf();
+	if (!source.empty()) setDisplayFlag(UI_DISPLAY_FLAG_TEX_PENDING);
+}
+
+uint32_t UIImage::uploadLoaded(uint32_t max) {
+	for (std::string& p : imageloader.takeFinished()) loadready.push_back(std::move(p));
+	uint32_t result = 0;
+	std::shared_ptr<const UIDecodedImage> d;
+	while (!loadready.empty() && result < max) {
+		const std::string path = std::move(loadready.front());
+		loadready.pop_front();
+		auto w = loadwaiters.find(path);
+		if (w == loadwaiters.end()) {
+			imageloader.unpin(path);
+			continue;
+		}
+		std::vector<UIImage*> waiting = std::move(w->second);
+		loadwaiters.erase(w);
+		d = imageloader.find(path);
+		imageloader.unpin(path);
+		for (UIImage* i : waiting) {
+			// cache was cleared in the meantime, start over
+			if (!d) i->setDisplayFlag(UI_DISPLAY_FLAG_TEX_PENDING);
+			else if (d->ok) {
+				if (!sourcetex.contains(i->source)) result++;
+				i->loadSource(d->pixels.data(), d->format, d->extent);
+			}
+			i->damageSelf();
+		}
+	}
+	return result;
+}
+
+void UIImage::setDecodeFunc(idfType f) {
+	imageloader.setDecodeFunc(f);
+}
+
+void UIImage::clearDecodeCache() {
+	imageloader.clear();
+}
+
+void UIImage::setDecodeCacheLimit(size_t bytes) {
+	imageloader.setCacheLimit(bytes);
+}
+
+UILoadStats UIImage::getLoadStats() {
+	UILoadStats result = imageloader.getStats();
+	result.uploads = loaduploads;
+	result.waiting = 0;
+	for (const auto& w : loadwaiters) result.waiting += w.second.size();
+	return result;
+}
+
+void UIImage::setTexCompression(UITexCompressFlags f, uint32_t mintexels) {
+	texcompress = f;
+	texcompressmin = mintexels;
+	imageloader.setCompression(f & UI_TEX_COMPRESS_IMAGES, mintexels);
+}
+
+UITexCompressStats UIImage::getTexCompressStats() {
+	UITexCompressStats result = compressstats;
+	result.encodems += imageloader.getEncodeMs();
+	return result;
+}
+
+VkDeviceSize UIImage::texBytes(const UIImageInfo& i) {
+	// block formats store 4x4 texels per block, partial blocks at the edges are whole ones
+	const VkDeviceSize blocks = (VkDeviceSize)((i.extent.width + 3) / 4) * ((i.extent.height + 3) / 4);
+	switch (i.format) {
+		case VK_FORMAT_R8_UNORM:
+			return (VkDeviceSize)i.extent.width * i.extent.height;
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			return blocks * 8;
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+			return blocks * 16;
+		default:
+			return (VkDeviceSize)i.extent.width * i.extent.height * 4;
+	}
+}
+
+// -- Protected --
+
+void UIImage::genPendingTex() {
+	unsetDisplayFlag(UI_DISPLAY_FLAG_TEX_PENDING);
+	if (source.empty()) return;
+	auto w = loadwaiters.find(source);
+	if (w != loadwaiters.end() && std::ranges::count(w->second, this)) return;
+	auto resident = sourcetex.find(source);
+	if (resident != sourcetex.end()) {
+		loadSource(nullptr, resident->second.format, resident->second.extent);
+		return;
+	}
+	std::shared_ptr<const UIDecodedImage> d = imageloader.request(source);
+	if (!d) loadwaiters[source].push_back(this);
+	else if (d->ok) loadSource(d->pixels.data(), d->format, d->extent);
+}
+
+bool UIImage::texShared() const {
+	auto users = imgusers.find(tex.image);
+	return users != imgusers.end() && users->second > 1;
+}
+
+void UIImage::updateEvictable() {
+	const bool candidate = !shownInTree() && loaded() && regenerable();
+	if (candidate && evictkey == lastdrawn) return;
+	if (evictkey != UINT64_MAX) evictable.erase({evictkey, this});
+	evictkey = UINT64_MAX;
+	if (candidate) {
+		evictkey = lastdrawn;
+		evictable.insert({evictkey, this});
+	}
+}
+
+void UIImage::setTexRegion(VkExtent2D content) {
+	const UIPushConstantFlags mask = UI_PC_TEX_REGION_MAX << UI_PC_TEX_REGION_SHIFT
+		| UI_PC_TEX_REGION_MAX << (UI_PC_TEX_REGION_SHIFT + UI_PC_TEX_REGION_BITS);
+	pcdata.flags &= ~mask;
+	// all of tex, or too big to say, in which case tex fits it exactly
+	if ((content.width == tex.extent.width && content.height == tex.extent.height)
+		|| content.width > UI_PC_TEX_REGION_MAX || content.height > UI_PC_TEX_REGION_MAX) return;
+	pcdata.flags |= content.width << UI_PC_TEX_REGION_SHIFT
+		| content.height << (UI_PC_TEX_REGION_SHIFT + UI_PC_TEX_REGION_BITS);
 }
 
 // -- Private --
 
+void UIImage::acquireTex(const UIImageInfo& i) {
+	if (i.image == VK_NULL_HANDLE || i.image == UIComponent::getNoTex().image) return;
+	if (imgusers.contains(i.image)) imgusers[i.image]++;
+	else {
+		imgusers[i.image] = 1;
+		imgbytes[i.image] = texBytes(i);
+		residentbytes += imgbytes[i.image];
+	}
+}
+
+// texDestroyFunc is called while tex is still the texture being destroyed
+bool UIImage::releaseTex() {
+	if (tex.image == VK_NULL_HANDLE || tex.image == UIComponent::getNoTex().image) return false;
+	if (imgusers[tex.image] == 1) {
+		imgusers.erase(tex.image);
+		residentbytes -= imgbytes[tex.image];
+		imgbytes.erase(tex.image);
+		UIText::forgetTex(tex.image);
+		forgetSourceTex(tex.image);
+		texDestroyFunc(this);
+		return true;
+	}
+	imgusers[tex.image]--;
+	return false;
+}
+
+void UIImage::releaseTex(const UIImageInfo& i, VkDescriptorSet d) {
+	UIImage holder;
+	holder.unsetDisplayFlag(UI_DISPLAY_FLAG_SHOW);
+	holder.tex = i;
+	holder.ds = d;
+	holder.releaseTex();
+	holder.tex = UIImageInfo();
+}
+
+void UIImage::loadSource(const unorm* data, VkFormat f, VkExtent2D e) {
+	auto resident = sourcetex.find(source);
+	if (resident != sourcetex.end()) setTex(resident->second);
+	else {
+		// make room before adding to the total
+		enforceTexBudget();
+		releaseTex();
+		tex = UIComponent::getNoTex();
+		tex.extent = e;
+		tex.format = f;
+		texLoadFunc(this, (void*)data);
+		loaduploads++;
+		texloads++;
+		if (loaded()) {
+			sourcetex[source] = tex;
+			sourcetexpaths[tex.image] = source;
+			if (f != VK_FORMAT_R8G8B8A8_UNORM) noteCompressed(tex, (VkDeviceSize)e.width * e.height * 4);
+		}
+	}
+	if (pcdata.extent == UICoord(0, 0)) pcdata.extent = UICoord(e.width, e.height);
+	updateEvictable();
+	damageSelf();
+}
+
+void UIImage::stopWaiting() {
+	auto w = loadwaiters.find(source);
+	if (w == loadwaiters.end()) return;
+	std::erase(w->second, this);
+	if (w->second.empty()) loadwaiters.erase(w);
+}
+
+void UIImage::resumeWaiting() {
+	if (!source.empty() && !loaded()) setDisplayFlag(UI_DISPLAY_FLAG_TEX_PENDING);
+}
+
+void UIImage::forgetSourceTex(VkImage i) {
+	auto path = sourcetexpaths.find(i);
+	if (path == sourcetexpaths.end()) return;
+	sourcetex.erase(path->second);
+	sourcetexpaths.erase(path);
+}
+
+void UIImage::evictTex() {
+	// other users of a shared texture keep it resident, so only count evictions that free something
+	if (releaseTex()) evictions++;
+	// keep extent so layout doesn't change while evicted
+	VkExtent2D e = tex.extent;
+	tex = UIComponent::getNoTex();
+	tex.extent = e;
+	setTexRegion({0, 0});
+	setDisplayFlag(UI_DISPLAY_FLAG_TEX_PENDING);
+	updateEvictable();
+}
+
+void UIImage::noteCompressed(const UIImageInfo& i, VkDeviceSize rawbytes) {
+	compressstats.textures++;
+	compressstats.rawbytes += rawbytes;
+	compressstats.compressedbytes += texBytes(i);
+}
+
 /* 
  * ----------
  * | UIText |
@@ -310,19 +1373,14 @@ void UIImage::setTex(const UIImageInfo& i) {
 
 FT_Library UIText::ft = nullptr;
 FT_Face UIText::typeface = nullptr;
+std::unordered_map<UIText::TexKey, UIText::CachedTex, UIText::TexKeyHash> UIText::texcache = {};
+std::unordered_map<VkImage, UIText::TexKey> UIText::texcachekeys = {};
+std::map<std::pair<FT_Face, uint32_t>, UIText::FontCache> UIText::fontcaches = {};
 
 // -- Public --
 
-UIText::UIText() : text(L""), UIImage() {
-	if (!ft) {
-		ft = FT_Library();
-		FT_Init_FreeType(&ft);
-	}
-	if (!typeface) {
-		// FT_New_Face(ft, UI_DEFAULT_SANS_FILEPATH, UI_DEFAULT_SANS_IDX, &typeface); 
-		// FT_New_Face(ft, UI_DEFAULT_SERIF_FILEPATH, UI_DEFAULT_SERIF_IDX, &typeface); 
-		FT_New_Face(ft, UI_DEFAULT_MONO_FILEPATH, UI_DEFAULT_MONO_IDX, &typeface); 
-	}
+UIText::UIText() : UIImage(), text(L""), wrapwidth(0) {
+	initFont();
 	pcdata.flags |= UI_PC_FLAG_BLEND;
 }
 
@@ -338,6 +1396,10 @@ UIText::UIText(std::wstring t, UICoord p) : UIText() {
 void swap(UIText& t1, UIText& t2) {
 	swap(static_cast<UIImage&>(t1), static_cast<UIImage&>(t2));
 	std::swap(t1.text, t2.text);
+	std::swap(t1.wrapwidth, t2.wrapwidth);
+	// the UIImage swap checked regenerable against the old text
+	t1.updateEvictable();
+	t2.updateEvictable();
 }
 
 UIText& UIText::operator=(UIText rhs) {
@@ -353,88 +1415,278 @@ void UIText::setDS(VkDescriptorSet d) {
 
 void UIText::setText(std::wstring t) {
 	text = t;
-	genTex();
+	damageSelf();
+	// text may have gone to or from empty, which decides whether it's regenerable
+	updateEvictable();
+	if (useCachedTex()) return;
+	const UITexelCoord res = measure();
+	pcdata.extent = res.x == 0 || res.y == 0 ? UICoord(0, 0) : extentFromTexels(res);
+	damageSelf();
+	setDisplayFlag(UI_DISPLAY_FLAG_TEX_PENDING);
+}
+
+void UIText::setWrapWidth(float w) {
+	if (w == wrapwidth) return;
+	wrapwidth = w;
+	setText(text);
+}
+
+UITextMetrics UIText::measureText(const std::wstring& t, float maxwidth) {
+	initFont();
+	const std::vector<Line> lines = layout(t, texelsFromExtent(maxwidth));
+	const UITexelCoord res = measure(lines);
+	UITextMetrics result = {res.x == 0 || res.y == 0 ? UICoord(0, 0) : extentFromTexels(res), {}};
+	result.lines.reserve(lines.size());
+	for (const Line& l : lines) result.lines.push_back({l.begin, l.end, extentFromTexels({(uint32_t)std::max(l.width, 0), 0}).x});
+	return result;
 }
 
 // -- Private --
 
-void UIText::genTex() {
-	const uint32_t fontsize = 32; // in pt
-	const uint32_t dpi = 72;
+void UIText::initFont() {
+	if (!ft) {
+		ft = FT_Library();
+		FT_Init_FreeType(&ft);
+	}
+	if (!typeface) {
+		// FT_New_Face(ft, UI_DEFAULT_SANS_FILEPATH, UI_DEFAULT_SANS_IDX, &typeface); 
+		// FT_New_Face(ft, UI_DEFAULT_SERIF_FILEPATH, UI_DEFAULT_SERIF_IDX, &typeface); 
+		FT_New_Face(ft, UI_DEFAULT_MONO_FILEPATH, UI_DEFAULT_MONO_IDX, &typeface); 
+	}
+}
+
+UIText::FontCache& UIText::fontCache() {
+	auto cached = fontcaches.find({typeface, fontsize});
+	if (cached != fontcaches.end()) return cached->second;
+	requestSize();
+	FontCache& f = fontcaches[{typeface, fontsize}];
+	f.ascender = typeface->size->metrics.ascender;
+	f.height = typeface->size->metrics.height;
+	f.haskerning = FT_HAS_KERNING(typeface);
+	return f;
+}
+
+FT_Pos UIText::advance(FontCache& f, wchar_t c) {
+	auto cached = f.advances.find(c);
+	if (cached != f.advances.end()) return cached->second;
+	requestSize();
+	FT_Load_Char(typeface, c, FT_LOAD_BITMAP_METRICS_ONLY);
+	return f.advances[c] = typeface->glyph->metrics.horiAdvance;
+}
+
+FT_Pos UIText::kerning(FontCache& f, wchar_t l, wchar_t r) {
+	if (!f.haskerning) return 0;
+	const uint64_t key = (uint64_t)(uint32_t)l << 32 | (uint32_t)r;
+	auto cached = f.kerning.find(key);
+	if (cached != f.kerning.end()) return cached->second;
+	requestSize();
+	FT_Vector k = {0, 0};
+	FT_Get_Kerning(typeface, FT_Get_Char_Index(typeface, l), FT_Get_Char_Index(typeface, r), FT_KERNING_DEFAULT, &k);
+	return f.kerning[key] = k.x;
+}
+
+std::vector<UIText::Line> UIText::layout(const std::wstring& t, uint32_t maxwidth) {
+	FontCache& f = fontCache();
+	std::vector<Line> result;
+	uint32_t begin = 0;
+	while (true) {
+		// contentwidth leaves out trailing spaces
+		int32_t width = 0, contentwidth = 0;
+		// where this line can be broken if it gets too wide: before a run of spaces
+		uint32_t brk = UINT32_MAX;
+		int32_t brkwidth = 0;
+		uint32_t i = begin;
+		bool wrapped = false;
+		for (; i < t.size() && t[i] != L'\n'; i++) {
+			// TODO: float, not trucated, bounds???
+			const int32_t w = width
+				+ (i > begin ? truncate26_6(kerning(f, t[i - 1], t[i])) : 0)
+				+ truncate26_6(advance(f, t[i]));
+			// trailing spaces can hang past maxwidth, they're dropped if the line wraps there anyway
+			if (maxwidth && w > (int32_t)maxwidth && i > begin && t[i] != L' ') {
+				wrapped = true;
+				break;
+			}
+			if (t[i] == L' ' && i > begin && t[i - 1] != L' ') {
+				brk = i;
+				brkwidth = width;
+			}
+			width = w;
+			if (t[i] != L' ') contentwidth = w;
+		}
+		if (!wrapped) {
+			// hanging spaces don't count towards the width when wrapping
+			result.push_back({begin, i, maxwidth ? contentwidth : width});
+			if (i >= t.size()) break;
+			begin = i + 1;
+		}
+		else if (brk != UINT32_MAX) {
+			result.push_back({begin, brk, brkwidth});
+			begin = brk;
+			while (begin < t.size() && t[begin] == L' ') begin++;
+			// the newline after the spaces is this break
+			if (begin < t.size() && t[begin] == L'\n') begin++;
+		}
+		else {
+			// one word wider than maxwidth
+			result.push_back({begin, i, width});
+			begin = i;
+		}
+	}
+	return result;
+}
+
+UITexelCoord UIText::measure(const std::vector<Line>& lines) {
+	int32_t maxwidth = 0;
+	for (const Line& l : lines) maxwidth = std::max(maxwidth, l.width);
+	return {(uint32_t)maxwidth, (uint32_t)lines.size() * (uint32_t)truncate26_6(fontCache().height)};
+}
+
+bool UIText::useCachedTex() {
+	auto cached = texcache.find({text, typeface, fontsize, wrapTexels()});
+	if (cached == texcache.end()) return false;
+	setTex(cached->second.tex);
+	setTexRegion(cached->second.content);
+	pcdata.extent = extentFromTexels({cached->second.content.width, cached->second.content.height});
+	damageSelf();
+	unsetDisplayFlag(UI_DISPLAY_FLAG_TEX_PENDING);
+	return true;
+}
+
+void UIText::forgetTex(VkImage i) {
+	auto key = texcachekeys.find(i);
+	if (key == texcachekeys.end()) return;
+	texcache.erase(key->second);
+	texcachekeys.erase(key);
+}
+
+void UIText::requestSize() {
 	FT_Size_RequestRec req {
 		FT_SIZE_REQUEST_TYPE_NOMINAL,
 		fontsize << 6, fontsize << 6,
 		dpi, dpi
 	};
 	FT_Request_Size(typeface, &req);
-	// TODO: float, not trucated, bounds???
-	uint32_t maxlinelength = 0, linelengthcounter = 0, numlines = 1;
-	for (char c : text) {
-		if (c == '\n') {
-			if (linelengthcounter > maxlinelength) maxlinelength = linelengthcounter;
-			linelengthcounter = 0;
-			numlines++;
-			continue;
-		}
-		FT_Load_Char(typeface, c, FT_LOAD_BITMAP_METRICS_ONLY);
-		linelengthcounter += truncate26_6(typeface->glyph->metrics.horiAdvance);
-	}
-	if (linelengthcounter > maxlinelength) maxlinelength = linelengthcounter;
-	// TODO: kerning???
+}
 
-	FT_Size_Metrics m = typeface->size->metrics;
-	m.ascender = truncate26_6(m.ascender);
-	m.descender = truncate26_6(m.descender);
-	m.height = truncate26_6(m.height);
-	const uint32_t hres = maxlinelength, vres = numlines * m.height;
+void UIText::genTex() {
+	unsetDisplayFlag(UI_DISPLAY_FLAG_TEX_PENDING);
+	if (useCachedTex()) return;
+	const std::vector<Line> lines = layout(text, wrapTexels());
+	const UITexelCoord res = measure(lines);
+	requestSize();
+
+	FontCache& f = fontCache();
+	const FT_Pos ascender = truncate26_6(f.ascender), height = truncate26_6(f.height);
+	const uint32_t hres = res.x, vres = res.y;
 	if (hres == 0 || vres == 0) {
 		texLoadFunc(this, nullptr);
 		pcdata.extent = UICoord(0, 0);
 		return;
 	}
-	// TODO: switch all hres, vres to this extent (?)
-	tex.extent = {hres, vres};
-	unorm* texturedata = (unorm*)malloc(hres * vres * sizeof(unorm));
-	// TODO: any way to realloc???
-	memset(&texturedata[0], 0.0f, hres * vres * sizeof(unorm));
-	UICoord penposition(0, vres - m.ascender);
+	// a texture no one else is using can be redrawn in place if the text fits, or replaced by a bigger one
+	const bool ours = texUpdateFunc && loaded() && !texShared()
+		&& hres <= UI_PC_TEX_REGION_MAX && vres <= UI_PC_TEX_REGION_MAX;
+	const bool inplace = ours && hres <= tex.extent.width && vres <= tex.extent.height;
+	// texels to write, from the bottom left
+	VkExtent2D dataext = {hres, vres};
+	if (inplace) {
+		// covering what's left of the old text too
+		VkExtent2D old = getTexRegion(pcdata);
+		if (old.width == 0) old = tex.extent;
+		dataext = {std::max(hres, old.width), std::max(vres, old.height)};
+		if (tex.format == VK_FORMAT_BC4_UNORM_BLOCK) {
+			dataext = {
+				std::min((dataext.width + 3) & ~3u, tex.extent.width),
+				std::min((dataext.height + 3) & ~3u, tex.extent.height)
+			};
+		}
+	}
+	else if (ours) {
+		dataext = {
+			hres <= tex.extent.width ? tex.extent.width : growTexels(tex.extent.width, hres),
+			vres <= tex.extent.height ? tex.extent.height : growTexels(tex.extent.height, vres)
+		};
+	}
+	const uint32_t stride = dataext.width;
+	unorm* texturedata = (unorm*)malloc((size_t)stride * dataext.height * sizeof(unorm));
+	memset(&texturedata[0], 0.0f, (size_t)stride * dataext.height * sizeof(unorm));
+	UICoord penposition(0, vres - ascender);
 
 	FT_Glyph_Metrics gm;
 	UICoord pixscan;
 	float hbx, hby, ha;
-	for (wchar_t c : text) {
-		if (c == '\n') {
-			penposition.y -= m.height;
-			penposition.x = 0;
-			continue;
-		}
-		FT_Load_Char(typeface, c, FT_LOAD_RENDER);
-		if (typeface->glyph) FT_Render_Glyph(typeface->glyph, FT_RENDER_MODE_NORMAL);
-		gm = typeface->glyph->metrics;
-		hbx = floatFrom26_6(gm.horiBearingX);
-		hby = floatFrom26_6(gm.horiBearingY);
-		ha = floatFrom26_6(gm.horiAdvance);
-		penposition += UICoord(hbx, hby);
-		unsigned char* bitmapbuffer = typeface->glyph->bitmap.buffer;
-		pixscan = UICoord(0, 0);
-		for (uint32_t y = 0; y < typeface->glyph->bitmap.rows; y++) {
-			for (uint32_t x = 0; x < typeface->glyph->bitmap.width; x++) {
-				pixscan.x = penposition.x + (float)x;
-				pixscan.y = penposition.y - (float)y;
-				texturedata[(size_t)floorf(pixscan.y * (float)hres + pixscan.x)] = 
-					std::max(*bitmapbuffer++, texturedata[(size_t)floorf(pixscan.y * (float)hres + pixscan.x)]);
+	for (const Line& l : lines) {
+		for (uint32_t i = l.begin; i < l.end; i++) {
+			// the pen moves by the same truncated metrics layout measured with, so glyphs land inside the line
+			if (i > l.begin) penposition.x += truncate26_6(kerning(f, text[i - 1], text[i]));
+			ha = truncate26_6(advance(f, text[i]));
+			FT_Load_Char(typeface, text[i], FT_LOAD_RENDER);
+			if (typeface->glyph) FT_Render_Glyph(typeface->glyph, FT_RENDER_MODE_NORMAL);
+			gm = typeface->glyph->metrics;
+			hbx = truncate26_6(gm.horiBearingX);
+			hby = truncate26_6(gm.horiBearingY);
+			penposition += UICoord(hbx, hby);
+			const FT_Bitmap& bitmap = typeface->glyph->bitmap;
+			for (uint32_t y = 0; y < bitmap.rows; y++) {
+				for (uint32_t x = 0; x < bitmap.width; x++) {
+					pixscan.x = penposition.x + (float)x;
+					pixscan.y = penposition.y - (float)y;
+					// kerning or a wide bearing can put a few texels outside
+					if (pixscan.x < 0 || pixscan.y < 0 || pixscan.x >= hres || pixscan.y >= vres) continue;
+					unorm& texel = texturedata[(size_t)floorf(pixscan.y * (float)stride + pixscan.x)];
+					texel = std::max(bitmap.buffer[y * bitmap.pitch + x], texel);
+				}
 			}
+			penposition += UICoord(ha - hbx, -hby);
 		}
-		penposition += UICoord(ha - hbx, -hby);
+		penposition.y -= height;
+		penposition.x = 0;
+	}
+	pcdata.extent = extentFromTexels(res);
+
+	if (inplace) {
+		std::vector<unorm> blocks;
+		if (tex.format == VK_FORMAT_BC4_UNORM_BLOCK) {
+			const auto start = std::chrono::steady_clock::now();
+			blocks = UIEncodeBC4(texturedata, dataext.width, dataext.height);
+			compressstats.encodems += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+		texUpdateFunc(this, blocks.empty() ? texturedata : blocks.data(), {{0, 0}, dataext});
+		texupdates++;
+		damageSelf();
+	}
+	else {
+		// make room before adding to the total
+		enforceTexBudget();
+		tex.extent = dataext;
+		if (texcompress & UI_TEX_COMPRESS_TEXT && (size_t)dataext.width * dataext.height >= texcompressmin) {
+			const auto start = std::chrono::steady_clock::now();
+			std::vector<unorm> blocks = UIEncodeBC4(texturedata, dataext.width, dataext.height);
+			compressstats.encodems += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			tex.format = VK_FORMAT_BC4_UNORM_BLOCK;
+			texLoadFunc(this, blocks.data());
+			if (loaded()) noteCompressed(tex, (VkDeviceSize)dataext.width * dataext.height);
+		}
+		else {
+			tex.format = VK_FORMAT_R8_UNORM;
+			texLoadFunc(this, texturedata);
+		}
+		texloads++;
 	}
-	// TODO: make into function
-	pcdata.extent = UICoord(hres, vres) / (float)dpi * 72.f * 1.33333333333f;
-
-	// TODO: allow for regeneration of (static size) texture
-	// consider adding size param too, that would allow for some data handling nuance
-	// and for utilization of static-sized textures
-	texLoadFunc(this, texturedata);
 	free(texturedata);
+	setTexRegion({hres, vres});
+	if (loaded()) {
+		// the old text is gone, and texLoadFunc may have reused an image that held other text
+		forgetTex(tex.image);
+		TexKey key = {text, typeface, fontsize, wrapTexels()};
+		texcache[key] = {tex, {hres, vres}};
+		texcachekeys[tex.image] = key;
+	}
+}
+
+uint32_t UIText::growTexels(uint32_t have, uint32_t need) {
+	return std::min((std::max(need, have * 2) + 3) & ~3u, std::max(need, UI_PC_TEX_REGION_MAX));
 }
 
 /* 
@@ -454,12 +1706,12 @@ UIDropdown::UIDropdown(UIDropdown&& rhs) noexcept :
 	rhs.options = {};
 }
 
-UIDropdown::UIDropdown(std::vector<std::wstring> o) : UIComponent() {
+UIDropdown::UIDropdown(std::vector<std::wstring> o) : unfolded(false), UIComponent() {
 	display |= UI_DISPLAY_FLAG_OVERFLOWING_CHILDREN;
 	setOptions(o);
 }
 
-UIDropdown::UIDropdown(std::vector<std::wstring> o, UICoord p, UICoord e) : UIComponent(p, e) {
+UIDropdown::UIDropdown(std::vector<std::wstring> o, UICoord p, UICoord e) : unfolded(false), UIComponent(p, e) {
 	display |= UI_DISPLAY_FLAG_OVERFLOWING_CHILDREN;
 	setOptions(o);
 }
@@ -472,7 +1724,7 @@ std::vector<const UIComponent*> UIDropdown::getChildren() const {
 
 void UIDropdown::setPos(UICoord p) {
 	UICoord diff = p - pcdata.position;
-	static_cast<UIComponent*>(this)->setPos(p);
+	UIComponent::setPos(p);
 	otherpos += diff;
 }
 
@@ -485,8 +1737,10 @@ void UIDropdown::setExt(UICoord e) {
 void UIDropdown::fold() {
 	if (unfolded) {
 		for (UIText& o : options) o.hide();
+		damageSelf();
 		std::swap(pcdata.position, otherpos);
 		std::swap(pcdata.extent, otherext);
+		damageSelf();
 	}
 	unfolded = false;
 }
@@ -494,8 +1748,10 @@ void UIDropdown::fold() {
 void UIDropdown::unfold() {
 	if (!unfolded) {
 		for (UIText& o : options) o.show();
+		damageSelf();
 		std::swap(pcdata.position, otherpos);
 		std::swap(pcdata.extent, otherext);
+		damageSelf();
 	}
 	unfolded = true;
 }
@@ -517,11 +1773,12 @@ void UIDropdown::setOptions(std::vector<std::wstring>& o) {
 	float height = getPos().y;
 	for (std::wstring& opt : o) {
 		options.emplace_back(opt);
+		adopt(&options.back());
 		options.back().setPos(this->getPos() + UICoord(0, height - options.back().getExt().y));
 		height = options.back().getPos().y;
 		if (options.back().getExt().x > otherext.x) otherext.x = options.back().getExt().x;
 		options.back().hide();
-		options.back().setGraphicsPipeline(graphicspipeline);
+		options.back().setGraphicsPipeline(getGraphicsPipeline());
 	}
 	otherext.y = getPos().y + getExt().y - options.back().getPos().y;
 	otherpos = options.back().getPos();
@@ -622,26 +1879,29 @@ std::vector<const UIComponent*> UIRibbon::getChildren() const {
 void UIRibbon::addOption(std::wstring name) {
 	float xlen = options.size() ? options.back().getPos().x + options.back().getExt().x : 0;
 	options.emplace_back(name);
+	adopt(&options.back());
 	options.back().setPos(UICoord(50 + xlen, this->getPos().y));
 	options.back().setExt(options.back().getExt() + UICoord(50, 0));
-	options.back().setGraphicsPipeline(graphicspipeline);
+	options.back().setGraphicsPipeline(getGraphicsPipeline());
 }
 
 void UIRibbon::addOption(UIDropdownButtons&& o) {
 	float xlen = options.size() ? options.back().getPos().x + options.back().getExt().x : 0;
 	options.emplace_back(o);
+	adopt(&options.back());
 	options.back().setPos(UICoord(50 + xlen, this->getPos().y));
 	options.back().setExt(options.back().getExt() + UICoord(50, 0));
-	options.back().setGraphicsPipeline(graphicspipeline);
+	options.back().setGraphicsPipeline(getGraphicsPipeline());
 }
 
 void UIRibbon::addOption(std::wstring t, std::vector<std::wstring> o) {
 	// TODO: consolidate in addOptionInternal
 	float xlen = options.size() ? options.back().getPos().x + options.back().getExt().x : 0;
 	options.emplace_back(t, o);
+	adopt(&options.back());
 	options.back().setPos(UICoord(50 + xlen, this->getPos().y));
 	options.back().setExt(options.back().getExt() + UICoord(50, 0));
-	options.back().setGraphicsPipeline(graphicspipeline);
+	options.back().setGraphicsPipeline(getGraphicsPipeline());
 }
 
 // -- Private --
@@ -651,3 +1911,347 @@ std::vector<UIComponent*> UIRibbon::_getChildren() {
 	for (size_t i = 0; i < options.size(); i++) result.push_back(&options[i]);
 	return result;
 }
+
+/*
+ * -------------------
+ * | UIMutationQueue |
+ * -------------------
+ */
+
+// -- Public --
+
+UIMutationQueue::~UIMutationQueue() {
+	Node* n;
+	while (tail) {
+		n = tail->next.load(std::memory_order_acquire);
+		delete tail;
+		tail = n;
+	}
+}
+
+void UIMutationQueue::push(std::function<void ()> f) {
+	Node* n = new Node();
+	n->f = std::move(f);
+	Node* prev = head.exchange(n, std::memory_order_acq_rel);
+	prev->next.store(n, std::memory_order_release);
+}
+
+size_t UIMutationQueue::apply() {
+	size_t result = 0;
+	Node* next;
+	while ((next = tail->next.load(std::memory_order_acquire))) {
+		delete tail;
+		tail = next;
+		// tail is the dummy now, so its function is free to take
+		std::function<void ()> f = std::move(tail->f);
+		f();
+		result++;
+	}
+	return result;
+}
+
+/*
+ * ---------------
+ * | UIScheduler |
+ * ---------------
+ */
+
+double UIScheduler::budget = 0;
+std::deque<std::function<void ()>> UIScheduler::queue = {};
+std::vector<UIComponent*> UIScheduler::offscreen = {};
+UISchedulerStats UIScheduler::stats = {};
+UISchedulerStats UIScheduler::last = {};
+bool UIScheduler::recording = false;
+
+// -- Public --
+
+void UIScheduler::beginFrame() {
+	stats.usedms = 0;
+	stats.done = 0;
+	stats.deferred = 0;
+	clearOffscreen();
+}
+
+uint32_t UIScheduler::endFrame() {
+	const uint32_t before = stats.done;
+	// at least one thing each frame, even if drawing used up the budget
+	auto more = [before] () {return stats.done == before || !overBudget();};
+	uint32_t uploaded = 1;
+	while (uploaded && more()) {
+		runTimed([&uploaded] () {uploaded = UIImage::uploadLoaded(1);});
+		stats.done += uploaded;
+	}
+	while (!queue.empty() && more()) {
+		std::function<void ()> f = std::move(queue.front());
+		queue.pop_front();
+		runTimed(f);
+		stats.done++;
+	}
+	// by index, as generating a texture can destroy components (e.g., in texLoadFunc), which nulls them here
+	for (size_t i = 0; i < offscreen.size() && more(); i++) {
+		UIComponent* c = offscreen[i];
+		if (!c || !(c->display & UI_DISPLAY_FLAG_TEX_PENDING)) continue;
+		runTimed([c] () {c->genPendingTex();});
+		stats.done++;
+	}
+	clearOffscreen();
+	stats.budgetms = budget;
+	stats.frames++;
+	if (budget > 0 && stats.usedms > budget) stats.overbudget++;
+	last = stats;
+	return stats.done - before;
+}
+
+UISchedulerStats UIScheduler::getStats() {
+	UISchedulerStats result = last;
+	result.queued = queue.size();
+	return result;
+}
+
+// -- Private --
+
+bool UIScheduler::genPendingTex(UIComponent* c) {
+	if (recording) return false;
+	if (budget > 0) {
+		const UIRect r = UIComponent::clipToScreen(c->getDrawRect());
+		if (r.extent.x <= 0 || r.extent.y <= 0) {
+			if (!(c->display & UI_DISPLAY_FLAG_OFFSCREEN)) {
+				c->display |= UI_DISPLAY_FLAG_OFFSCREEN;
+				offscreen.push_back(c);
+			}
+			stats.deferred++;
+			return false;
+		}
+		// usedms starts at 0, so the first texture of a frame is always made
+		if (overBudget()) {
+			stats.deferred++;
+			return false;
+		}
+	}
+	runTimed([c] () {c->genPendingTex();});
+	stats.done++;
+	return true;
+}
+
+void UIScheduler::forget(const UIComponent* c) {
+	std::replace(offscreen.begin(), offscreen.end(), const_cast<UIComponent*>(c), (UIComponent*)nullptr);
+}
+
+void UIScheduler::clearOffscreen() {
+	for (UIComponent* c : offscreen) if (c) c->display &= ~UI_DISPLAY_FLAG_OFFSCREEN;
+	offscreen.clear();
+}
+
+void UIScheduler::runTimed(const std::function<void ()>& f) {
+	const auto start = std::chrono::steady_clock::now();
+	f();
+	stats.usedms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * --------------------
+ * | UIFrameSnapshots |
+ * --------------------
+ */
+
+// -- Public --
+
+UIFrameSnapshots::~UIFrameSnapshots() {
+	releaseTextures(front);
+	releaseTextures(back);
+	for (Buffer& b : retired) releaseTextures(b);
+}
+
+void UIFrameSnapshots::capture(const std::vector<const UIComponent*>& roots) {
+	std::erase_if(retired, [] (Buffer& b) {
+		if (b.data.use_count() > 1) return false;
+		// pairs with the release of the render thread's last reference, before its textures can be destroyed
+		std::atomic_thread_fence(std::memory_order_acquire);
+		releaseTextures(b);
+		return true;
+	});
+	// back is only shared if a render thread is still holding on to it from a previous frame
+	if (back.data && back.data.use_count() > 1) {
+		retired.push_back(std::move(back));
+		back = {nullptr, {}};
+	}
+	if (!back.data) back.data = std::make_shared<std::vector<UIDrawData>>();
+	else std::atomic_thread_fence(std::memory_order_acquire);
+	// taken before releasing the old ones, so textures in both frames aren't destroyed in between
+	std::vector<std::pair<UIImageInfo, VkDescriptorSet>> old = std::move(back.textures);
+	back.textures.clear();
+	back.data->clear();
+	for (const UIComponent* r : roots) r->collectDrawData(*back.data);
+	for (const UIDrawData& d : *back.data) {
+		const UIImageInfo* t = d.source->getTexInfo();
+		if (t && t->image != VK_NULL_HANDLE && t->image != UIComponent::getNoTex().image) {
+			back.textures.push_back({*t, d.ds});
+		}
+	}
+	std::sort(back.textures.begin(), back.textures.end(), [] (const auto& a, const auto& b) {
+		return a.first.image < b.first.image;
+	});
+	back.textures.erase(std::unique(back.textures.begin(), back.textures.end(), [] (const auto& a, const auto& b) {
+		return a.first.image == b.first.image;
+	}), back.textures.end());
+	for (const auto& t : back.textures) UIImage::acquireTex(t.first);
+	for (const auto& t : old) UIImage::releaseTex(t.first, t.second);
+	std::lock_guard<std::mutex> lock(frontmutex);
+	std::swap(front, back);
+}
+
+UIFrameSnapshots::Snapshot UIFrameSnapshots::acquire() const {
+	std::lock_guard<std::mutex> lock(frontmutex);
+	return front.data;
+}
+
+// -- Private --
+
+void UIFrameSnapshots::releaseTextures(Buffer& b) {
+	for (const auto& t : b.textures) UIImage::releaseTex(t.first, t.second);
+	b.textures.clear();
+}
+
+/*
+ * --------------
+ * | UIDrawList |
+ * --------------
+ */
+
+// -- Public --
+
+void UIDrawList::build(const std::vector<const UIComponent*>& roots) {
+	collected.clear();
+	for (const UIComponent* r : roots) r->collectDrawData(collected);
+	buildFrom(collected);
+}
+
+void UIDrawList::buildFrom(const std::vector<UIDrawData>& drawdata) {
+	items.clear();
+	batches.clear();
+	rects.clear();
+	order.clear();
+	stats = {};
+
+	// what's visible, in tree order
+	const VkExtent2D screen = UIComponent::getScreenExtent();
+	UIRect bounds = {{0, 0}, {0, 0}};
+	for (uint32_t i = 0; i < drawdata.size(); i++) {
+		UIRect r = UIComponent::getDrawRect(drawdata[i]);
+		if (screen.width && screen.height) {
+			const UICoord lo(std::max(r.position.x, 0.f), std::max(r.position.y, 0.f)),
+				hi(std::min(r.position.x + r.extent.x, (float)screen.width),
+					std::min(r.position.y + r.extent.y, (float)screen.height));
+			r = {lo, hi - lo};
+		}
+		if (r.empty()) {
+			stats.culled++;
+			continue;
+		}
+		bounds = order.empty() ? r : bounds.merge(r);
+		order.push_back(i);
+		rects.push_back(r);
+		if (order.size() == 1 || !sameState(drawdata[order[order.size() - 2]], drawdata[i])) stats.treebatches++;
+	}
+	stats.items = order.size();
+	if (order.empty()) return;
+
+	// an item must come after everything earlier it overlaps, except items with its state, which stable
+	// sorting within the layer keeps in order anyway
+	// cells about twice the average item, so items span few cells and cells hold few items
+	double meanside = 0;
+	for (const UIRect& r : rects) meanside += std::max(r.extent.x, r.extent.y);
+	float cellsize = std::clamp((float)(2 * meanside / rects.size()), 16.f, 256.f);
+	// without a screen to clip to, items can be arbitrarily far apart
+	cellsize = std::max(cellsize, sqrtf(bounds.extent.x * bounds.extent.y / UI_DRAWLIST_MAX_CELLS));
+	while ((ceilf(bounds.extent.x / cellsize) + 1) * (ceilf(bounds.extent.y / cellsize) + 1) > UI_DRAWLIST_MAX_CELLS) {
+		cellsize *= 2;
+	}
+	const uint32_t gw = (uint32_t)ceilf(bounds.extent.x / cellsize) + 1,
+		gh = (uint32_t)ceilf(bounds.extent.y / cellsize) + 1;
+	if (cells.size() < (size_t)gw * gh) cells.resize((size_t)gw * gh);
+	for (size_t c = 0; c < (size_t)gw * gh; c++) cells[c].clear();
+	cellmax.assign((size_t)gw * gh, 0);
+	celltop.resize((size_t)gw * gh);
+	cellmixed.assign((size_t)gw * gh, false);
+	layers.assign(order.size(), 0);
+	for (uint32_t k = 0; k < order.size(); k++) {
+		const UIRect& r = rects[k];
+		const uint32_t x0 = (r.position.x - bounds.position.x) / cellsize,
+			y0 = (r.position.y - bounds.position.y) / cellsize,
+			x1 = std::min(gw - 1, (uint32_t)((r.position.x + r.extent.x - bounds.position.x) / cellsize)),
+			y1 = std::min(gh - 1, (uint32_t)((r.position.y + r.extent.y - bounds.position.y) / cellsize));
+		uint32_t layer = 0;
+		for (uint32_t y = y0; y <= y1; y++) {
+			for (uint32_t x = x0; x <= x1; x++) {
+				const size_t c = (size_t)y * gw + x;
+				// nothing here can raise layer past cellmax, or to it if every item at cellmax shares k's state,
+				// so a stack of same-state items doesn't rescan the whole stack for each one
+				auto settled = [&] () {
+					return layer > cellmax[c] || (layer == cellmax[c] && !cellmixed[c]
+						&& sameState(drawdata[order[celltop[c]]], drawdata[order[k]]));
+				};
+				// newest first, as they tend to be in the highest layers, stopping once nothing here can raise layer
+				for (auto j = cells[c].rbegin(); j != cells[c].rend() && !settled(); j++) {
+					const UIRect& o = rects[*j];
+					// edges touching isn't overlapping, no pixel center is in both
+					if (r.position.x < o.position.x + o.extent.x && o.position.x < r.position.x + r.extent.x
+						&& r.position.y < o.position.y + o.extent.y && o.position.y < r.position.y + r.extent.y) {
+						layer = std::max(layer, layers[*j] + !sameState(drawdata[order[*j]], drawdata[order[k]]));
+					}
+				}
+			}
+		}
+		for (uint32_t y = y0; y <= y1; y++) {
+			for (uint32_t x = x0; x <= x1; x++) {
+				const size_t c = (size_t)y * gw + x;
+				if (cells[c].empty() || layer > cellmax[c]) {
+					cellmax[c] = layer;
+					celltop[c] = k;
+					cellmixed[c] = false;
+				}
+				else if (layer == cellmax[c] && !sameState(drawdata[order[celltop[c]]], drawdata[order[k]])) {
+					cellmixed[c] = true;
+				}
+				cells[c].push_back(k);
+			}
+		}
+		layers[k] = layer;
+		stats.layers = std::max(stats.layers, layer + 1);
+	}
+
+	// counting sort by layer, which keeps tree order within each
+	std::vector<uint32_t> layerstart(stats.layers + 1, 0);
+	for (uint32_t l : layers) layerstart[l + 1]++;
+	for (uint32_t l = 0; l < stats.layers; l++) layerstart[l + 1] += layerstart[l];
+	sorted.resize(order.size());
+	{
+		std::vector<uint32_t> next(layerstart.begin(), layerstart.end() - 1);
+		for (uint32_t k = 0; k < order.size(); k++) sorted[next[layers[k]]++] = order[k];
+	}
+
+	// then by state, starting with the state the previous layer ended on so the batch continues
+	items.reserve(order.size());
+	for (uint32_t l = 0; l < stats.layers; l++) {
+		const UIDrawData* prev = items.empty() ? nullptr : &items.back();
+		std::stable_sort(sorted.begin() + layerstart[l], sorted.begin() + layerstart[l + 1],
+			[&drawdata, prev] (uint32_t a, uint32_t b) {
+				const UIDrawData& da = drawdata[a];
+				const UIDrawData& db = drawdata[b];
+				const bool acont = prev && sameState(da, *prev), bcont = prev && sameState(db, *prev);
+				if (acont != bcont) return acont;
+				return std::make_pair((uintptr_t)da.pipeline, (uintptr_t)da.ds)
+					< std::make_pair((uintptr_t)db.pipeline, (uintptr_t)db.ds);
+			});
+		for (uint32_t i = layerstart[l]; i < layerstart[l + 1]; i++) {
+			const UIDrawData& d = drawdata[sorted[i]];
+			if (items.empty() || !sameState(items.back(), d)) {
+				batches.push_back({d.pipeline, d.layout, d.ds, (uint32_t)items.size(), 0});
+			}
+			batches.back().count++;
+			items.push_back(d);
+		}
+	}
+	stats.batches = batches.size();
+}
+
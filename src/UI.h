@@ -1,13 +1,27 @@
+#pragma once
+
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <deque>
 #include <map>
+#include <set>
+#include <unordered_set>
+#include <unordered_map>
+#include <atomic>
 #include <iostream>
 #include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <tuple>
 #include <ctgmath>
 #include <vulkan/vulkan.h>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+// UI_DEFAULT_MONO_FILEPATH can be defined at build time to use another font, as the tests do
 #ifdef __APPLE__
 #define UI_DEFAULT_SANS_FILEPATH "/System/Library/fonts/HelveticaNeue.ttc"
 #define UI_DEFAULT_SANS_IDX 0
@@ -15,12 +29,16 @@
 // #define UI_DEFAULT_SERIF_FILEPATH "/System/Library/fonts/Hiragino Sans GB.ttc"
 // #define UI_DEFAULT_SERIF_FILEPATH "/System/Library/fonts/Apple Color Emoji.ttc"
 #define UI_DEFAULT_SERIF_IDX 0
+#ifndef UI_DEFAULT_MONO_FILEPATH
 #define UI_DEFAULT_MONO_FILEPATH "/System/Library/fonts/Monaco.ttf"
+#endif
 #define UI_DEFAULT_MONO_IDX 0
 #else
 #define UI_DEFAULT_SANS_FILEPATH "/usr/share/fonts/truetype/noto/NotoSansDisplay-Regular.ttf"
 #define UI_DEFAULT_SANS_IDX 0
+#ifndef UI_DEFAULT_MONO_FILEPATH
 #define UI_DEFAULT_MONO_FILEPATH "/usr/share/fonts/truetype/ubuntu/UbuntuSansMono[wght].ttf"
+#endif
 #define UI_DEFAULT_MONO_IDX 0
 #endif
 #define UI_DEFAULT_BG_COLOR (UIColor){0.3, 0.3, 0.3, 1}
@@ -29,6 +47,18 @@
 
 // #define VERBOSE_IMAGE_OBJECTS
 
+// more damage rects than this get merged into one
+#define UI_MAX_DAMAGE_RECTS 8
+
+// see UIImage::setDecodeCacheLimit
+#define UI_DEFAULT_DECODE_CACHE_LIMIT (64 << 20)
+
+// UIDrawList's overlap grid grows its cells to stay within this many, however far apart items are
+#define UI_DRAWLIST_MAX_CELLS (1 << 16)
+
+// coordinate frame of components not inside a UIContainer
+#define UI_SCREEN_FRAME 0
+
 class UIComponent;
 
 class UIImage;
@@ -41,8 +71,14 @@ typedef std::function<void (UIImage*, void*)> tfType;
 
 typedef std::function<void (UIImage*)> tdfType;
 
+// copies data, tightly packed in the image's getTex().format, into a region of its existing getTex().image
+typedef std::function<void (UIImage*, void*, VkRect2D)> tufType;
+
 typedef std::function<void (UIComponent*, void*)> cfType;
 
+// decodes the file at a path to 8-bit RGBA, top row first; called on loader threads, so must be thread-safe
+typedef std::function<bool (const std::string&, std::vector<unorm>&, VkExtent2D&)> idfType;
+
 typedef struct UIPipelineInfo {
 	VkPipelineLayout layout = VK_NULL_HANDLE;
 	VkPipeline pipeline = VK_NULL_HANDLE;
@@ -112,6 +148,29 @@ typedef struct UICoord {
 	}
 } UICoord;
 
+// screen region, in the same coordinates as UICoord
+typedef struct UIRect {
+	UICoord position, extent;
+
+	bool empty() const {return extent.x <= 0 || extent.y <= 0;}
+	bool contains(const UIRect& rhs) const {
+		return position.x <= rhs.position.x && position.y <= rhs.position.y
+			&& rhs.position.x + rhs.extent.x <= position.x + extent.x
+			&& rhs.position.y + rhs.extent.y <= position.y + extent.y;
+	}
+	bool overlaps(const UIRect& rhs) const {
+		return position.x <= rhs.position.x + rhs.extent.x && rhs.position.x <= position.x + extent.x
+			&& position.y <= rhs.position.y + rhs.extent.y && rhs.position.y <= position.y + extent.y;
+	}
+	// bounding box of both
+	UIRect merge(const UIRect& rhs) const {
+		UICoord lo(std::min(position.x, rhs.position.x), std::min(position.y, rhs.position.y)),
+			hi(std::max(position.x + extent.x, rhs.position.x + rhs.extent.x),
+				std::max(position.y + extent.y, rhs.position.y + rhs.extent.y));
+		return {lo, hi - lo};
+	}
+} UIRect;
+
 typedef struct UITexelCoord {
 	uint32_t x, y;
 
@@ -145,12 +204,140 @@ typedef enum UIPushConstantFlagBits {
 } UIPushConstantFlagBits;
 typedef uint32_t UIPushConstantFlags;
 
+/*
+ * Above the flag bits, UIPushConstantData::flags can hold the texel width and height of the part of the texture
+ * that's in use, from its bottom left, for textures with room to spare (see UIImage::setTexUpdateFunc). 0 means
+ * all of it. UIFragment.glsl scales its texture coordinates to that part, custom shaders should too.
+ */
+#define UI_PC_TEX_REGION_SHIFT 4
+#define UI_PC_TEX_REGION_BITS 14
+#define UI_PC_TEX_REGION_MAX ((1u << UI_PC_TEX_REGION_BITS) - 1)
+
 typedef struct UIPushConstantData {
 	UIColor bgcolor = UI_DEFAULT_BG_COLOR;
 	UICoord position = {0, 0}, extent = {0, 0};
 	UIPushConstantFlags flags = UI_PC_FLAG_NONE;
 } UIPushConstantData;
 
+/*
+ * Analytic widget chrome, drawn by UIFragment.glsl without any texture. It's shared through UIStyle, and follows
+ * UIPushConstantData in the shaders' push constant block, so drawFuncs push it at offset
+ * sizeof(UIPushConstantData) (the offsets line up with GLSL's layout rules). All zeros draws as before.
+ */
+typedef struct UIChromeData {
+	float cornerradius = 0, borderwidth = 0, shadowblur = 0;
+	UIColor bordercolor = {0, 0, 0, 0}, shadowcolor = {0, 0, 0, 0};
+	UICoord shadowoffset = {0, 0};
+} UIChromeData;
+
+typedef struct UITexStats {
+	VkDeviceSize residentbytes, budget;
+	uint32_t residenttextures;
+	uint64_t evictions;
+	// calls to texLoadFunc and texUpdateFunc
+	uint64_t loads, updates;
+} UITexStats;
+
+// see UIImage::setSource
+typedef struct UILoadStats {
+	uint64_t decoded, failed, cachehits, uploads;
+	uint32_t queued; // decodes not yet finished
+	uint32_t waiting; // components waiting on those decodes
+	size_t cachebytes; // see UIImage::setDecodeCacheLimit
+	uint64_t cacheevictions;
+} UILoadStats;
+
+// see UIScheduler, of the last frame except for queued and the totals
+typedef struct UISchedulerStats {
+	double budgetms, usedms;
+	// textures generated, decodes uploaded and scheduled work run
+	uint32_t done;
+	// textures put off to a later frame for being over budget or off screen
+	uint32_t deferred;
+	uint32_t queued; // scheduled work not yet run
+	// overbudget counts frames that ran past the budget, by however long their last piece of work took
+	uint64_t frames, overbudget;
+} UISchedulerStats;
+
+// one line of UIText::measureText
+typedef struct UITextLine {
+	uint32_t begin, end; // indices into the text, end excludes the newline or spaces it broke at
+	float width;
+} UITextLine;
+
+typedef struct UITextMetrics {
+	UICoord extent; // what a UIText of the same text would be
+	std::vector<UITextLine> lines;
+} UITextMetrics;
+
+typedef uint8_t UITexCompressFlags;
+
+// see UIImage::setTexCompression
+typedef enum UITexCompressFlagBits {
+	UI_TEX_COMPRESS_NONE =   0x00,
+	UI_TEX_COMPRESS_TEXT =   0x01, // UIText coverage as VK_FORMAT_BC4_UNORM_BLOCK
+	UI_TEX_COMPRESS_IMAGES = 0x02  // UIImage::setSource images as VK_FORMAT_BC1_RGB_UNORM_BLOCK, or BC3 with alpha
+} UITexCompressFlagBits;
+
+// totals since startup, for textures created compressed
+typedef struct UITexCompressStats {
+	uint64_t textures;
+	VkDeviceSize rawbytes, compressedbytes; // size they would have been uncompressed, and as created
+	double encodems; // CPU time spent encoding, including on loader threads
+} UITexCompressStats;
+
+// everything needed to draw one component, copied out of it so it can be used without touching the component
+typedef struct UIDrawData {
+	const UIComponent* source; // for identification only, may be changed or destroyed by the time this is used
+	UIPushConstantData pcdata;
+	UIChromeData chrome;
+	VkPipeline pipeline;
+	VkPipelineLayout layout;
+	VkDescriptorSet ds;
+	VkImage image; // VK_NULL_HANDLE for non-UIImages
+} UIDrawData;
+
+// consecutive items of a UIDrawList that share state, so it only needs binding once
+typedef struct UIDrawBatch {
+	VkPipeline pipeline;
+	VkPipelineLayout layout;
+	VkDescriptorSet ds;
+	uint32_t first, count; // range of UIDrawList::getItems()
+} UIDrawBatch;
+
+typedef struct UIDrawListStats {
+	uint32_t items; // drawn
+	uint32_t culled; // off screen or zero size
+	uint32_t layers; // groups of items with no overlaps, drawn in order
+	uint32_t batches;
+	uint32_t treebatches; // runs of equal state the items had in tree order, i.e., batches without sorting
+} UIDrawListStats;
+
+// number of times each kind of event callback has been called, see UIComponent::getEventStats
+typedef struct UIEventStats {
+	uint64_t hover, hoverbegin, hoverend,
+		click, clickbegin, clickend;
+} UIEventStats;
+
+typedef uint32_t UIStyleHandle;
+
+#define UI_DEFAULT_STYLE 0
+
+/*
+ * State that almost every component shares. Components hold a UIStyleHandle into a static table instead
+ * of their own copy; overriding a field copies the record first if anything else is still using it.
+ */
+typedef struct UIStyle {
+	UIPipelineInfo graphicspipeline;
+	dfType drawFunc;
+	cfType onHover, onHoverBegin, onHoverEnd,
+		onClick, onClickBegin, onClickEnd;
+	UIColor bgcolor = UI_DEFAULT_BG_COLOR,
+		hoverbgcolor = UI_DEFAULT_HOVER_BG_COLOR,
+		clickbgcolor = UI_DEFAULT_CLICK_BG_COLOR;
+	UIChromeData chrome;
+} UIStyle;
+
 typedef uint8_t UIEventFlags;
 
 typedef enum UIEventFlagBits {
@@ -163,52 +350,43 @@ typedef uint8_t UIDisplayFlags;
 
 typedef enum UIDisplayFlagBits {
 	UI_DISPLAY_FLAG_SHOW =                 0x01,
-	UI_DISPLAY_FLAG_OVERFLOWING_CHILDREN = 0x02
+	UI_DISPLAY_FLAG_OVERFLOWING_CHILDREN = 0x02,
+	// texture is out of date, and will be generated the next time this is drawn while shown
+	UI_DISPLAY_FLAG_TEX_PENDING =          0x04,
+	// in UIScheduler's off-screen list, which holds this object's address, so copies and swaps don't take it
+	UI_DISPLAY_FLAG_OFFSCREEN =            0x08,
+	// something this is inside of is hidden, so it isn't drawn whatever SHOW says, kept up to date by hide, show
+	// and adding it to a container
+	UI_DISPLAY_FLAG_HIDDEN_ANCESTOR =      0x10
 } UIDisplayFlagBits;
 
 class UIComponent {
 public:
 	UIComponent() : 
 		pcdata({UI_DEFAULT_BG_COLOR, {0, 0}, {0, 0}, UI_PC_FLAG_NONE}),
-		graphicspipeline(defaultgraphicspipeline),
-		drawFunc(defaultDrawFunc), 
-		onHover(defaultOnHover),
-		onHoverBegin(defaultOnHoverBegin),
-		onHoverEnd(defaultOnHoverEnd),
-		onClick(defaultOnClick),
-		onClickBegin(defaultOnClickBegin),
-		onClickEnd(defaultOnClickEnd),
-		ds(defaultds), 
+		display(UI_DISPLAY_FLAG_SHOW),
 		events(UI_EVENT_FLAG_NONE),
-		display(UI_DISPLAY_FLAG_SHOW) {}
+		ds(defaultds), 
+		style(UI_DEFAULT_STYLE),
+		frame(UI_SCREEN_FRAME) {}
 	UIComponent(UICoord p, UICoord e) : 
 		pcdata({UI_DEFAULT_BG_COLOR, p, e, UI_PC_FLAG_NONE}), 
-		graphicspipeline(defaultgraphicspipeline),
-		drawFunc(defaultDrawFunc), 
-		onHover(defaultOnHover),
-		onHoverBegin(defaultOnHoverBegin),
-		onHoverEnd(defaultOnHoverEnd),
-		onClick(defaultOnClick),
-		onClickBegin(defaultOnClickBegin),
-		onClickEnd(defaultOnClickEnd),
-		ds(defaultds),
+		display(UI_DISPLAY_FLAG_SHOW),
 		events(UI_EVENT_FLAG_NONE),
-		display(UI_DISPLAY_FLAG_SHOW) {}
+		ds(defaultds),
+		style(UI_DEFAULT_STYLE),
+		frame(UI_SCREEN_FRAME) {}
+	// copies keep rhs's coordinate frame, as that's what their position is relative to
 	UIComponent(const UIComponent& rhs) :
 		pcdata(rhs.pcdata),
-		graphicspipeline(rhs.graphicspipeline),
-		drawFunc(rhs.drawFunc),
-		onHover(rhs.onHover),
-		onHoverBegin(rhs.onHoverBegin),
-		onHoverEnd(rhs.onHoverEnd),
-		onClick(rhs.onClick),
-		onClickBegin(rhs.onClickBegin),
-		onClickEnd(rhs.onClickEnd),
-		ds(rhs.ds),
+		display(rhs.display & ~(UI_DISPLAY_FLAG_OFFSCREEN | UI_DISPLAY_FLAG_HIDDEN_ANCESTOR)),
 		events(rhs.events),
-		display(rhs.display) {}
+		ds(rhs.ds),
+		style(acquireStyle(rhs.style)),
+		frame(rhs.frame) {}
 	UIComponent(UIComponent&& rhs) noexcept;
-	virtual ~UIComponent() = default;
+	// damages where this was, if it was shown
+	virtual ~UIComponent();
 
 	friend void swap(UIComponent& c1, UIComponent& c2);
 
@@ -219,37 +397,119 @@ public:
 
 	// cb must have been started already
 	void draw(const VkCommandBuffer& cb) const;
+	// generates any pending textures in the shown part of this tree, without drawing
+	void prepareDraw() const;
+	// appends what draw would draw, in the same order
+	void collectDrawData(std::vector<UIDrawData>& out) const;
+	/*
+	 * Records roots[i] into secondaries[i] on a pool of threads, then executes the secondaries in primary in the
+	 * order given (i.e., painter's order). Each secondary must come from a command pool that no other thread
+	 * is using during the call, and primary must be inside a render pass begun with
+	 * VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS matching inheritance. The roots must not overlap or be
+	 * modified until this returns.
+	 *
+	 * In this mode drawFuncs run concurrently, so they must be thread-safe: only record into the cb they're
+	 * given, and treat anything shared (descriptor pools, staging buffers, etc.) accordingly. As secondaries
+	 * inherit no dynamic state, drawFunc should also set any it depends on.
+	 *
+	 * Recording threads are kept between calls. Returns false without recording anything if there are fewer
+	 * secondaries than roots. With no roots, nothing is recorded or executed.
+	 */
+	static bool drawParallel(
+		const std::vector<const UIComponent*>& roots,
+		const std::vector<VkCommandBuffer>& secondaries,
+		const VkCommandBufferInheritanceInfo& inheritance,
+		const VkCommandBuffer& primary);
 	void listenMousePos(UICoord mousepos, void* data);
 	void listenMouseClick(bool click, void* data);
 
-	static void setDefaultGraphicsPipeline(const UIPipelineInfo& p) {defaultgraphicspipeline = p;}
-	static UIPipelineInfo getDefaultGraphicsPipeline() {return defaultgraphicspipeline;}
+	// default style changes apply to every component still using UI_DEFAULT_STYLE
+	static void setDefaultGraphicsPipeline(const UIPipelineInfo& p) {styles[UI_DEFAULT_STYLE].graphicspipeline = p;}
+	static UIPipelineInfo getDefaultGraphicsPipeline() {return styles[UI_DEFAULT_STYLE].graphicspipeline;}
 	static void setNoTex(UIImageInfo i) {notex = i;}
 	static UIImageInfo getNoTex() {return notex;}
 	static void setDefaultDS(VkDescriptorSet d) {defaultds = d;}
 	static VkDescriptorSet getDefaultDS() {return defaultds;}
-	static void setDefaultDrawFunc(dfType ddf) {defaultDrawFunc = ddf;}
-	void setOnClickBegin(cfType f) {onClickBegin = f;}
-	void setOnHoverEnd(cfType f) {onHoverEnd = f;}
-	static void setScreenExtent(VkExtent2D e) {screenextent = e;}
+	static void setDefaultDrawFunc(dfType ddf) {styles[UI_DEFAULT_STYLE].drawFunc = ddf;}
+	// returned handle stays valid until destroyStyle, even if no component is using it
+	static UIStyleHandle createStyle(const UIStyle& s);
+	static void destroyStyle(UIStyleHandle h) {releaseStyle(h);}
+	static const UIStyle& getStyle(UIStyleHandle h) {return styles[h];}
+	static size_t getNumStyles() {return styles.size() - freestyles.size();}
+	const UIStyle& getStyle() const {return styles[style];}
+	UIStyleHandle getStyleHandle() const {return style;}
+	void setStyle(UIStyleHandle h);
+	void setDrawFunc(dfType f) {writableStyle().drawFunc = f;}
+	void setOnHover(cfType f) {writableStyle().onHover = f;}
+	void setOnHoverBegin(cfType f) {writableStyle().onHoverBegin = f;}
+	void setOnHoverEnd(cfType f) {writableStyle().onHoverEnd = f;}
+	void setOnClick(cfType f) {writableStyle().onClick = f;}
+	void setOnClickBegin(cfType f) {writableStyle().onClickBegin = f;}
+	void setOnClickEnd(cfType f) {writableStyle().onClickEnd = f;}
+	static void setScreenExtent(VkExtent2D e) {
+		screenextent = e;
+		damageAll();
+	}
+	static VkExtent2D getScreenExtent() {return screenextent;}
+	/*
+	 * Screen regions that may look different since the last takeDamage, from setters, hover/click transitions,
+	 * show/hide, and texture changes. If it's empty, the last frame can be presented again; otherwise only the
+	 * returned rects need redrawing (e.g., with scissors). Changes made through getPCDataPtr, or by drawFunc
+	 * or callbacks outside of setters, aren't tracked; report them with addDamage.
+	 */
+	static const std::vector<UIRect>& getDamage() {return damagerects;}
+	static std::vector<UIRect> takeDamage();
+	static void addDamage(UIRect r);
+	static void damageAll() {addDamage({{0, 0}, UICoord(screenextent.width, screenextent.height)});}
+	// screen region this component's drawFunc can touch, including its shadow
+	UIRect getDrawRect() const;
+	// same for a component's draw data
+	static UIRect getDrawRect(const UIDrawData& d);
+	static UIEventStats getEventStats() {return eventstats;}
+	static void resetEventStats() {eventstats = {};}
 	// TODO: phase out in favor of pass-by-reference
 	UIPushConstantData* getPCDataPtr() {return &pcdata;}
-	const UIPushConstantData& getPCData() const {return pcdata;}
-	// also changes position of children
-	void setPos(UICoord p);
+	// position is relative to the enclosing UIContainer, except during drawFunc, where it's absolute
+	const UIPushConstantData& getPCData() const {return this == drawing ? drawingpcdata : pcdata;}
+	// relative to the enclosing UIContainer (see UIContainer::getChildOrigin), also moves children
+	virtual void setPos(UICoord p);
 	UICoord getPos() const {return pcdata.position;}
-	void setExt(UICoord e) {pcdata.extent = e;}
+	// in screen coordinates, O(depth of nested UIContainers)
+	UICoord getAbsPos() const;
+	void setExt(UICoord e);
 	UICoord getExt() const {return pcdata.extent;}
-	void setBGCol(UIColor c) {pcdata.bgcolor = c;}
+	void setBGCol(UIColor c);
+	// chrome lives in the style, so prefer a shared style (createStyle) when styling many components alike
+	const UIChromeData& getChrome() const {return styles[style].chrome;}
+	void setChrome(const UIChromeData& c);
+	void setCornerRadius(float r);
+	void setBorder(float w, UIColor c);
+	void setShadow(UICoord offset, float blur, UIColor c);
 	// also sets childrens' graphics pipelines
 	void setGraphicsPipeline(const UIPipelineInfo& p);
-	const UIPipelineInfo& getGraphicsPipeline() const {return graphicspipeline;}
+	const UIPipelineInfo& getGraphicsPipeline() const {return styles[style].graphicspipeline;}
 	virtual void setDS(VkDescriptorSet d) {ds = d;}
 	const VkDescriptorSet& getDS() const {return ds;}
 	// TODO: phase out in favor of pass-by-reference
 	VkDescriptorSet* getDSPtr() {return &ds;}
-	void setDisplayFlag(UIDisplayFlags f) {display |= f;}
-	void unsetDisplayFlag(UIDisplayFlags f) {display &= ~f;}
+	// the texture this draws, nullptr for components without one (i.e., not UIImages)
+	virtual const UIImageInfo* getTexInfo() const {return nullptr;}
+	void setDisplayFlag(UIDisplayFlags f) {
+		display |= f;
+		if (f & UI_DISPLAY_FLAG_SHOW) {
+			shownChanged();
+			propagateShown();
+		}
+	}
+	void unsetDisplayFlag(UIDisplayFlags f) {
+		display &= ~f;
+		if (f & UI_DISPLAY_FLAG_SHOW) {
+			shownChanged();
+			propagateShown();
+		}
+	}
+	// shown, and not inside anything hidden
+	bool shownInTree() const {return (display & (UI_DISPLAY_FLAG_SHOW | UI_DISPLAY_FLAG_HIDDEN_ANCESTOR)) == UI_DISPLAY_FLAG_SHOW;}
 	void show();
 	void hide();
 
@@ -257,30 +517,80 @@ protected:
 	UIPushConstantData pcdata;
 	static VkExtent2D screenextent;
 	UIDisplayFlags display;
-	UIPipelineInfo graphicspipeline;
+	// here rather than private so it packs next to display
+	UIEventFlags events;
 	VkDescriptorSet ds;
 
 	virtual std::vector<UIComponent*> _getChildren() {return {};}
+	// damages this component, and if it's shown, its shown descendants
+	void damageShown();
+	void damageSelf();
+	// coordinate frame this component's children's positions are in
+	virtual uint32_t childFrame() const {return frame;}
+	// puts c and its descendants in childFrame(), for components that create children after being added
+	void adopt(UIComponent* c) const;
+	// updates UI_DISPLAY_FLAG_HIDDEN_ANCESTOR of descendants after this is shown or hidden
+	void propagateShown();
+	// draws just this component if it's shown, returning whether it was
+	bool drawSelf(const VkCommandBuffer& cb) const;
+	// overridable so containers can traverse their children without building a vector
+	virtual void drawChildren(const VkCommandBuffer& cb) const;
+	virtual void listenChildrenMousePos(UICoord mousepos, void* data);
+	virtual void listenChildrenMouseClick(bool click, void* data);
+	// called before drawing if UI_DISPLAY_FLAG_TEX_PENDING is set, should unset it
+	virtual void genPendingTex() {unsetDisplayFlag(UI_DISPLAY_FLAG_TEX_PENDING);}
+	// called by drawSelf each time this is drawn, possibly from several threads at once (see drawParallel)
+	virtual void markDrawn() const {}
+	// whether the texture this had when UI_DISPLAY_FLAG_TEX_PENDING was set can be drawn until the new one's made
+	virtual bool staleTexDrawable() const {return true;}
+	// called after UI_DISPLAY_FLAG_SHOW or UI_DISPLAY_FLAG_HIDDEN_ANCESTOR is set or unset
+	virtual void shownChanged() {}
 
 private:
-	dfType drawFunc;
-	cfType onHover, onHoverBegin, onHoverEnd,
-		onClick, onClickBegin, onClickEnd;
-	UIEventFlags events;
-	static UIPipelineInfo defaultgraphicspipeline;
+	UIStyleHandle style;
+	// frame id of the UIContainer pcdata.position is relative to, kept up to date by traversal
+	mutable uint32_t frame;
 	static UIImageInfo notex;
 	static VkDescriptorSet defaultds;
-	static dfType defaultDrawFunc;
+	// the component in drawFunc on this thread and its pcdata with an absolute position, see getPCData
+	static thread_local const UIComponent* drawing;
+	static thread_local UIPushConstantData drawingpcdata;
+	static UIEventStats eventstats;
+	static std::vector<UIRect> damagerects;
+
+	static UIRect clipToScreen(UIRect r);
 	static cfType defaultOnHover, defaultOnHoverBegin, defaultOnHoverEnd, 
 			defaultOnClick, defaultOnClickBegin, defaultOnClickEnd;
+	// deque so that references (e.g., a callback currently executing) survive new styles being added
+	static std::deque<UIStyle> styles;
+	static std::vector<uint32_t> styleusers;
+	static std::vector<UIStyleHandle> freestyles;
+	// interns pipeline overrides, so a subtree given one pipeline ends up sharing one derived style
+	static std::map<std::pair<UIStyleHandle, VkPipeline>, UIStyleHandle> pipelinestyles;
+
+	static UIStyleHandle allocStyle(const UIStyle& s);
+	static UIStyleHandle acquireStyle(UIStyleHandle h);
+	static void releaseStyle(UIStyleHandle h);
+	static void forgetDerivedStyle(UIStyleHandle h);
+	// copy-on-write access to this component's style
+	UIStyle& writableStyle();
+	// generates a pending texture if UIScheduler lets it, false if there's still nothing to draw
+	bool texReady() const;
+
+	friend class UIContainer;
+	friend class UIScheduler;
 };
 
+/*
+ * Children's positions are relative to the container (offset by its scroll), so moving or scrolling it is O(1)
+ * however many descendants it has. Their absolute positions are resolved when they're drawn, and mouse
+ * positions are made relative as they're passed down. Damage from a move covers the bounds of the shown
+ * descendants, which are cached until something in the subtree changes.
+ */
 class UIContainer : public UIComponent {
 public:
-	UIContainer() = default;
-	UIContainer(const UIContainer& rhs) :
-		children(rhs.children),
-		UIComponent(rhs) {};
+	UIContainer();
+	UIContainer(const UIContainer& rhs);
 	~UIContainer();
 
 	friend void swap(UIContainer& c1, UIContainer& c2);
@@ -288,6 +598,12 @@ public:
 	UIContainer& operator=(UIContainer rhs);
 
 	std::vector<const UIComponent*> getChildren() const;
+	void setPos(UICoord p);
+	// moves all children by -s
+	void setScroll(UICoord s);
+	UICoord getScroll() const {return scroll;}
+	// screen position that children's positions are relative to
+	UICoord getChildOrigin() const {return getAbsPos() - scroll;}
 	/*
 	 * This template function is a little hack to get the appropriate contructor called for classes like
 	 * UIText, which needs to monitor how many objects are using which texture. Implicitly, T should
@@ -296,18 +612,91 @@ public:
 	 * It returns the heap-alloc'd pointer for further ops. Allows for a UIHandler to keep all these pointers straight itself if it needs to, without overhead in here.
 	 */
 	// TODO: option to use rvalue ref and move
+	// c's position is taken as relative to this container
 	template<class T>
 	T* addChild(const T& c) {
 		children.push_back(dynamic_cast<UIComponent*>(new T(c)));
+		copiers.push_back([] (const UIComponent* o) {return dynamic_cast<UIComponent*>(new T(*dynamic_cast<const T*>(o)));});
+		adopt(children.back());
+		children.back()->damageShown();
 		return dynamic_cast<T*>(children.back());
 	}
 
 private:
+	UICoord scroll;
+	uint32_t frameid;
+	// covers shown descendants' draw rects, relative to getChildOrigin; it only grows until recomputed
+	mutable UIRect contentbounds;
+	mutable bool boundsdirty;
+
 	std::vector<UIComponent*> _getChildren();
+	void drawChildren(const VkCommandBuffer& cb) const;
+	void listenChildrenMousePos(UICoord mousepos, void* data);
+	void listenChildrenMouseClick(bool click, void* data);
+	uint32_t childFrame() const {return frameid;}
+	const UIRect& getContentBounds() const;
+	void damageContent() const;
 	
 	// heap-alloc'd pointer vector, alloc'd and freed by UIContainer, so that we can have any type of
 	// UIComponent
 	std::vector<UIComponent*> children;
+	// parallel to children, copies a child as the type it was added as, for copying the container
+	std::vector<UIComponent* (*)(const UIComponent*)> copiers;
+
+	// indexed by frame id, UI_SCREEN_FRAME is always null
+	static std::vector<const UIContainer*> frames;
+	static std::vector<uint32_t> freeframes;
+
+	static uint32_t allocFrame(const UIContainer* c);
+	static void accumulateBounds(const UIComponent* c, UIRect& r);
+	static void growBounds(uint32_t f, const UIRect& r);
+
+	friend class UIComponent;
+};
+
+/*
+ * Container for a structure that's known at compile time. Children are stored inline in a tuple and traversal
+ * is unrolled over them, so there's no heap allocation, dynamic_cast, or building of child vectors. It's still a
+ * UIComponent, so it can be added to a UIContainer (or hold one) like anything else.
+ */
+template<class... Ts>
+class UIStaticContainer : public UIComponent {
+	static_assert((std::is_base_of_v<UIComponent, Ts> && ...), "UIStaticContainer children must be UIComponents");
+
+public:
+	UIStaticContainer() = default;
+	UIStaticContainer(const Ts&... c) : UIComponent(), children(c...) {}
+	UIStaticContainer(UICoord p, UICoord e, const Ts&... c) : UIComponent(p, e), children(c...) {}
+
+	template<size_t I>
+	auto& get() {return std::get<I>(children);}
+	template<size_t I>
+	const auto& get() const {return std::get<I>(children);}
+
+	std::vector<const UIComponent*> getChildren() const {
+		return std::apply([] (const Ts&... c) {return std::vector<const UIComponent*>{&c...};}, children);
+	}
+	// hides UIComponent::draw, so nested UIStaticContainers are drawn without going through drawChildren
+	void draw(const VkCommandBuffer& cb) const {
+		if (drawSelf(cb)) UIStaticContainer::drawChildren(cb);
+	}
+
+protected:
+	std::vector<UIComponent*> _getChildren() {
+		return std::apply([] (Ts&... c) {return std::vector<UIComponent*>{&c...};}, children);
+	}
+	void drawChildren(const VkCommandBuffer& cb) const {
+		std::apply([&cb] (const Ts&... c) {(c.draw(cb), ...);}, children);
+	}
+	void listenChildrenMousePos(UICoord mousepos, void* data) {
+		std::apply([&mousepos, data] (Ts&... c) {(c.listenMousePos(mousepos, data), ...);}, children);
+	}
+	void listenChildrenMouseClick(bool click, void* data) {
+		std::apply([click, data] (Ts&... c) {(c.listenMouseClick(click, data), ...);}, children);
+	}
+
+private:
+	std::tuple<Ts...> children;
 };
 
 class UIImage : public UIComponent {
@@ -315,6 +704,7 @@ public:
 	// instead of making these public, could add public intermediary functions to UIImage
 	static tfType texLoadFunc;
 	static tdfType texDestroyFunc;
+	static tufType texUpdateFunc;
 
 	// Note: default constructor does not initialize the texture
 	UIImage();
@@ -329,31 +719,149 @@ public:
 
 	std::vector<const UIComponent*> getChildren() const {return {};}
 	virtual void setDS(VkDescriptorSet d) {ds = d;}
-	const UIImageInfo& getTex() {return tex;}
+	const UIImageInfo& getTex() const {return tex;}
+	const UIImageInfo* getTexInfo() const {return &tex;}
 	void setTex(const UIImageInfo& i);
 
 	static void setTexLoadFunc(tfType tf) {texLoadFunc = tf;}
 	static void setTexDestroyFunc(tdfType tdf) {texDestroyFunc = tdf;}
+	/*
+	 * Lets UIText redraw changed text into the texture it already has, when it's the only user and the text
+	 * fits, instead of creating a new one. Textures that outgrow their text are recreated with room to spare
+	 * (doubling like a vector), so steady-state setText creates no textures. Unset (the default), every change
+	 * of text goes through texLoadFunc.
+	 */
+	static void setTexUpdateFunc(tufType tuf) {texUpdateFunc = tuf;}
+	// the part of pc's texture in use (see UI_PC_TEX_REGION_SHIFT), {0, 0} for all of it
+	static VkExtent2D getTexRegion(const UIPushConstantData& pc);
+	/*
+	 * Once textures total more than b bytes, the least-recently-drawn hidden components (or ones in a hidden
+	 * container) that can regenerate their texture (e.g., UIText) have it destroyed, to be regenerated next time
+	 * they're drawn while shown.
+	 * 0 (the default) means no budget. Checked before generating new textures and by enforceTexBudget.
+	 */
+	static void setTexBudget(VkDeviceSize b) {texbudget = b;}
+	static void enforceTexBudget();
+	static UITexStats getTexStats();
+
+	/*
+	 * Shows notex until the image at path has been decoded on a worker thread, decoding only once this is
+	 * first drawn while shown. Decoded pixels are cached by path, and components with the same source share
+	 * one texture. If extent is {0, 0} it's set to the image's size in pixels once loaded.
+	 */
+	void setSource(std::string path);
+	const std::string& getSource() const {return source;}
+	/*
+	 * Hands finished decodes to texLoadFunc (as VK_FORMAT_R8G8B8A8_UNORM unless setTexCompression says
+	 * otherwise) for the components waiting on them. Call on the thread that owns those components, once per
+	 * frame before drawing. At most max textures are created per call, the rest wait for the next. Returns
+	 * the number created.
+	 */
+	static uint32_t uploadLoaded(uint32_t max = UINT32_MAX);
+	// defaults to PNG files
+	static void setDecodeFunc(idfType f);
+	// frees decoded pixels, textures already created aren't affected
+	static void clearDecodeCache();
+	/*
+	 * Decoded pixels are only needed again to recreate a texture that's been destroyed, so the least recently
+	 * used are dropped once the cache holds more than bytes (UI_DEFAULT_DECODE_CACHE_LIMIT by default). Decodes
+	 * not yet uploaded and the latest decode are always kept, so images still load whatever the limit.
+	 */
+	static void setDecodeCacheLimit(size_t bytes);
+	static UILoadStats getLoadStats();
+	/*
+	 * Block-compresses new textures of the kinds in f with at least mintexels texels before they reach
+	 * texLoadFunc, with tex.format set to the compressed format. Needs the textureCompressionBC device
+	 * feature, so it's off by default. Text uses 1/2 the memory, opaque images 1/8 and others 1/4; the cost
+	 * is some encode time and slight blurring at glyph edges. Decodes already cached (see clearDecodeCache)
+	 * and textures already created keep their format.
+	 */
+	static void setTexCompression(UITexCompressFlags f, uint32_t mintexels = 64 * 64);
+	static UITexCompressStats getTexCompressStats();
+	// bytes of data texLoadFunc is given for a texture like i
+	static VkDeviceSize texBytes(const UIImageInfo& i);
 
 protected:
 	UIImageInfo tex;
 
+	void genPendingTex();
+	// whether genPendingTex can recreate tex after it's been evicted
+	virtual bool regenerable() const {return !source.empty();}
+	void markDrawn() const {lastdrawn = drawclock.fetch_add(1, std::memory_order_relaxed);}
+	void shownChanged() {updateEvictable();}
+	// call when anything evictable depends on changes (tex, visibility or regenerable)
+	void updateEvictable();
+
+	static UITexCompressFlags texcompress;
+	static uint32_t texcompressmin;
+	static UITexCompressStats compressstats;
+	static uint64_t texloads, texupdates;
+
+	// counts a texture created compressed
+	static void noteCompressed(const UIImageInfo& i, VkDeviceSize rawbytes);
+	bool loaded() const {return tex.image != VK_NULL_HANDLE && tex.image != UIComponent::getNoTex().image;}
+	// whether other components hold tex too
+	bool texShared() const;
+	// only the bottom left content of tex is drawn, cleared again by setTex with a different image
+	void setTexRegion(VkExtent2D content);
+
 private:
-	std::vector<UIComponent*> _getChildren() {return {};}
+	// drawclock value when last drawn, for eviction order
+	mutable uint64_t lastdrawn;
+	// lastdrawn when added to evictable, which doesn't change while hidden, UINT64_MAX if not in it
+	uint64_t evictkey;
+	std::string source;
 
-	static std::map<VkImage, uint8_t> imgusers;
+	std::vector<UIComponent*> _getChildren() {return {};}
+	static void acquireTex(const UIImageInfo& i);
+	// returns whether tex was destroyed, i.e., this was its last user
+	bool releaseTex();
+	// for references held by something other than a component, texDestroyFunc gets a hidden UIImage with i and d
+	static void releaseTex(const UIImageInfo& i, VkDescriptorSet d);
+	void evictTex();
+	// takes the shared texture for source, creating it from data if there isn't one yet
+	void loadSource(const unorm* data, VkFormat f, VkExtent2D e);
+	void stopWaiting();
+	// after a copy or swap, so waiting components are waited on by the right object
+	void resumeWaiting();
+
+	static std::map<VkImage, uint32_t> imgusers;
+	static std::map<VkImage, VkDeviceSize> imgbytes;
+	// hidden components with a texture they can regenerate, least recently drawn first
+	static std::set<std::pair<uint64_t, UIImage*>> evictable;
+	static std::atomic<uint64_t> drawclock;
+	static VkDeviceSize texbudget, residentbytes;
+	static uint64_t evictions;
+	// textures created from a source, like UIText::texcache
+	static std::unordered_map<std::string, UIImageInfo> sourcetex;
+	static std::unordered_map<VkImage, std::string> sourcetexpaths;
+	static std::unordered_map<std::string, std::vector<UIImage*>> loadwaiters;
+	// finished decodes not yet uploaded
+	static std::deque<std::string> loadready;
+	static uint64_t loaduploads;
+
+	static void forgetSourceTex(VkImage i);
+
+	friend class UIComponent;
+	friend class UIFrameSnapshots;
 };
 
 class UIText : public UIImage {
 public:
 	// Note: default constructor does not initialize the texture
 	UIText();
+	// UIImage's constructor checked regenerable before text was set
 	UIText(const UIText& rhs) :
+		UIImage(rhs),
 		text(rhs.text),
-		UIImage(rhs) {}
+		wrapwidth(rhs.wrapwidth) {updateEvictable();}
 	UIText(UIText&& rhs) noexcept :
+		UIImage(rhs),
 		text(std::move(rhs.text)),
-		UIImage(rhs) {}
+		wrapwidth(rhs.wrapwidth) {
+		rhs.updateEvictable();
+		updateEvictable();
+	}
 	UIText(std::wstring t);
 	UIText(std::wstring t, UICoord p); 
 	~UIText() = default;
@@ -363,21 +871,102 @@ public:
 	UIText& operator=(UIText rhs);
 
 	void setDS(VkDescriptorSet d);
+	// extent is updated immediately, but the texture isn't generated (nor the old one drawn) until this is first
+	// drawn while shown
 	void setText(std::wstring t);
 	const std::wstring& getText() {return text;}
+	// w > 0 wraps lines to fit in w as measureText does, 0 (the default) only breaks at newlines
+	void setWrapWidth(float w);
+	float getWrapWidth() const {return wrapwidth;}
+	/*
+	 * Lays out t as a UIText would draw it, from cached glyph advances and kerning, without rasterizing. If
+	 * maxwidth > 0, lines are broken at spaces to fit in it, or mid-word if a word doesn't fit on its own.
+	 */
+	static UITextMetrics measureText(const std::wstring& t, float maxwidth = 0);
 
 private:
 	std::wstring text;
-
+	float wrapwidth;
+
+	// a line of laid out text, in texels
+	typedef struct Line {
+		uint32_t begin, end;
+		int32_t width;
+	} Line;
+
+	// glyph metrics of one face at one size, filled in as glyphs are first measured
+	typedef struct FontCache {
+		FT_Pos ascender, height;
+		bool haskerning;
+		std::unordered_map<wchar_t, FT_Pos> advances;
+		// keyed by left << 32 | right
+		std::unordered_map<uint64_t, FT_Pos> kerning;
+	} FontCache;
+
+	static std::map<std::pair<FT_Face, uint32_t>, FontCache> fontcaches;
+
+	static void initFont();
+	// for the current typeface and size
+	static FontCache& fontCache();
+	static FT_Pos advance(FontCache& f, wchar_t c);
+	static FT_Pos kerning(FontCache& f, wchar_t l, wchar_t r);
+	// breaks t into lines no wider than maxwidth texels, 0 for no limit
+	static std::vector<Line> layout(const std::wstring& t, uint32_t maxwidth);
+	// texel resolution of lines as genTex would rasterize them
+	static UITexelCoord measure(const std::vector<Line>& lines);
+	UITexelCoord measure() const {return measure(layout(text, wrapTexels()));}
+	uint32_t wrapTexels() const {return texelsFromExtent(wrapwidth);}
 	void genTex();
+	void genPendingTex() {genTex();}
+	// width or height of a texture of have texels grown to fit need, a multiple of 4 so BC4 regions are whole blocks
+	static uint32_t growTexels(uint32_t have, uint32_t need);
+	bool regenerable() const {return !text.empty();}
+	// the old text would be stretched to the new text's extent, so nothing is drawn until it's regenerated
+	bool staleTexDrawable() const {return false;}
+	// takes a resident texture of the same text if there is one, returns false otherwise
+	bool useCachedTex();
+
+	// identical text shares one texture, through imgusers like any other shared texture
+	typedef struct TexKey {
+		std::wstring text;
+		FT_Face face;
+		uint32_t size;
+		uint32_t wrap;
+
+		bool operator==(const TexKey& rhs) const = default;
+	} TexKey;
+	struct TexKeyHash {
+		size_t operator()(const TexKey& k) const {
+			return std::hash<std::wstring>()(k.text) ^ (std::hash<FT_Face>()(k.face) << 1) ^ k.size ^ ((size_t)k.wrap << 8);
+		}
+	};
+	// tex can have room to spare (see UIImage::setTexUpdateFunc), the text is the content at its bottom left
+	typedef struct CachedTex {
+		UIImageInfo tex;
+		VkExtent2D content;
+	} CachedTex;
+	static std::unordered_map<TexKey, CachedTex, TexKeyHash> texcache;
+	static std::unordered_map<VkImage, TexKey> texcachekeys;
+
+	// called by UIImage once nothing is using i anymore
+	static void forgetTex(VkImage i);
 	
 	std::vector<UIComponent*> _getChildren() {return {};}
 
 	static FT_Library ft;
 	static FT_Face typeface;
+	static constexpr uint32_t fontsize = 32; // in pt
+	static constexpr uint32_t dpi = 72;
+
+	static void requestSize();
+	static UICoord extentFromTexels(UITexelCoord t) {return UICoord(t.x, t.y) / (float)dpi * 72.f * 1.33333333333f;}
+	// inverse of extentFromTexels, rounding down, allowing for that not being exact
+	static uint32_t texelsFromExtent(float x) {return std::max(x, 0.f) * (float)dpi / 72.f / 1.33333333333f + 0.001f;}
 
 	static FT_Pos truncate26_6(FT_Pos x) {return x >> 6;}
 	static float floatFrom26_6(FT_Pos x) {return (float)x / (float)(1 << 6);}
+
+	friend class UIImage;
 };
 
 class UIDropdown : public UIComponent {
@@ -458,3 +1047,158 @@ private:
 
 	std::vector<UIComponent*> _getChildren();
 };
+
+/*
+ * Lets any thread queue changes to components, to be made on the thread that owns them (i.e., the one
+ * drawing and listening) when it calls apply, usually once per frame. push is lock-free. The queue doesn't
+ * keep components alive, so they must outlive any mutation queued on them.
+ */
+class UIMutationQueue {
+public:
+	UIMutationQueue() : head(new Node()), tail(head.load()) {}
+	UIMutationQueue(const UIMutationQueue& rhs) = delete;
+	~UIMutationQueue();
+
+	UIMutationQueue& operator=(const UIMutationQueue& rhs) = delete;
+
+	void push(std::function<void ()> f);
+	void setText(UIText* c, std::wstring t) {push([c, t] () {c->setText(t);});}
+	void setPos(UIComponent* c, UICoord p) {push([c, p] () {c->setPos(p);});}
+	void setExt(UIComponent* c, UICoord e) {push([c, e] () {c->setExt(e);});}
+	void setBGCol(UIComponent* c, UIColor col) {push([c, col] () {c->setBGCol(col);});}
+	void show(UIComponent* c) {push([c] () {c->show();});}
+	void hide(UIComponent* c) {push([c] () {c->hide();});}
+	// runs everything pushed so far, in the order pushed, returning how many were run; owning thread only
+	size_t apply();
+
+private:
+	typedef struct Node {
+		std::atomic<Node*> next = nullptr;
+		std::function<void ()> f;
+	} Node;
+
+	// producers append at head, the consumer pops from tail (a dummy node whose successor is next up)
+	std::atomic<Node*> head;
+	Node* tail;
+};
+
+/*
+ * Spreads expensive UI work over frames, so opening a big menu or building lots of components doesn't show up
+ * as one long frame. Call beginFrame before drawing and endFrame right after, on the thread that owns the
+ * components. With a budget set, drawing generates the pending textures of on-screen components until budget
+ * ms have gone to UI work this frame, and the rest stay pending. Components with no texture at all yet aren't
+ * drawn until theirs is made, like images still decoding. endFrame spends what's left of the budget on
+ * uploading finished decodes (in place of UIImage::uploadLoaded), then scheduled work, then textures of
+ * components that were shown but off screen. Each frame does at least one texture and one other piece of work,
+ * so nothing starves behind the rest.
+ */
+class UIScheduler {
+public:
+	// 0 (the default) means no budget: pending textures are generated whenever they're drawn
+	static void setBudget(double ms) {budget = ms;}
+	static double getBudget() {return budget;}
+	static void beginFrame();
+	// returns how much work was done
+	static uint32_t endFrame();
+	// e.g. building or laying out components, run by endFrame in the order scheduled
+	static void schedule(std::function<void ()> f) {queue.push_back(std::move(f));}
+	static UISchedulerStats getStats();
+
+private:
+	static double budget;
+	static std::deque<std::function<void ()>> queue;
+	// shown components whose textures were put off for being off screen, with UI_DISPLAY_FLAG_OFFSCREEN set,
+	// until endFrame; ones destroyed meanwhile are nulled out
+	static std::vector<UIComponent*> offscreen;
+	static UISchedulerStats stats, last;
+	// set while drawParallel's threads record, so none of them generate textures
+	static bool recording;
+
+	// generates c's pending texture if it's on screen and within budget, returns whether it did
+	static bool genPendingTex(UIComponent* c);
+	static void forget(const UIComponent* c);
+	static void clearOffscreen();
+	static void runTimed(const std::function<void ()>& f);
+	static bool overBudget() {return budget > 0 && stats.usedms >= budget;}
+
+	friend class UIComponent;
+};
+
+/*
+ * Double-buffered, immutable per-frame copies of the draw data of some roots. The owning thread captures a
+ * frame (after applying any queued mutations), and a render thread acquires the latest one and records from
+ * it while the owning thread moves on to the next frame. Buffers are reused once no render thread holds them.
+ *
+ * Each snapshot holds a reference to the textures it draws, like one more component using them, so they stay
+ * valid while it's recorded even if their components change or go away meanwhile: texDestroyFunc runs at a
+ * later capture, once no render thread holds a snapshot using the texture, and as it's shared, UIText makes a
+ * new texture rather than calling texUpdateFunc on it. Descriptor sets are the host's, so if drawData's ds is
+ * per texture, free it in texDestroyFunc (which gets that ds through getDS) rather than when a component
+ * changes. Destroy a UIFrameSnapshots only once no render thread holds a snapshot from it.
+ */
+class UIFrameSnapshots {
+public:
+	typedef std::shared_ptr<const std::vector<UIDrawData>> Snapshot;
+
+	UIFrameSnapshots() : front({nullptr, {}}), back({nullptr, {}}) {}
+	UIFrameSnapshots(const UIFrameSnapshots& rhs) = delete;
+	~UIFrameSnapshots();
+
+	UIFrameSnapshots& operator=(const UIFrameSnapshots& rhs) = delete;
+
+	// owning thread only
+	void capture(const std::vector<const UIComponent*>& roots);
+	// any thread, returns nullptr if nothing has been captured yet
+	Snapshot acquire() const;
+
+private:
+	// a captured frame and the textures it holds
+	typedef struct Buffer {
+		std::shared_ptr<std::vector<UIDrawData>> data;
+		std::vector<std::pair<UIImageInfo, VkDescriptorSet>> textures;
+	} Buffer;
+
+	Buffer front, back;
+	// buffers replaced while a render thread still held them, their textures are released once it lets go
+	std::vector<Buffer> retired;
+	mutable std::mutex frontmutex;
+
+	static void releaseTextures(Buffer& b);
+};
+
+/*
+ * Draw data of some roots reordered to minimize state changes, for hosts that record from UIDrawData rather
+ * than through drawFuncs. Items are split into layers, where an item goes in a later layer than anything
+ * before it in tree order that it overlaps (unless they share state), so nothing in a layer overlaps and
+ * each layer can be sorted by (pipeline, ds) freely. The result looks exactly like drawing in tree order.
+ * Record each batch by binding its pipeline and ds, then pushing and drawing each of its items in order.
+ */
+class UIDrawList {
+public:
+	UIDrawList() : stats({}) {}
+
+	// owning thread only, as with collectDrawData
+	void build(const std::vector<const UIComponent*>& roots);
+	// from data already collected in tree order (e.g., a UIFrameSnapshots::Snapshot), so any thread
+	void buildFrom(const std::vector<UIDrawData>& drawdata);
+	const std::vector<UIDrawData>& getItems() const {return items;}
+	const std::vector<UIDrawBatch>& getBatches() const {return batches;}
+	const UIDrawListStats& getStats() const {return stats;}
+
+private:
+	std::vector<UIDrawData> items;
+	std::vector<UIDrawBatch> batches;
+	UIDrawListStats stats;
+	// reused between builds
+	std::vector<UIDrawData> collected;
+	std::vector<UIRect> rects;
+	std::vector<uint32_t> layers, order, sorted;
+	std::vector<std::vector<uint32_t>> cells;
+	// highest layer in each cell, an item in it at that layer, and whether others there differ in state
+	std::vector<uint32_t> cellmax, celltop;
+	std::vector<bool> cellmixed;
+
+	static bool sameState(const UIDrawData& a, const UIDrawData& b) {
+		return a.pipeline == b.pipeline && a.ds == b.ds;
+	}
+};
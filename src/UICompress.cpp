@@ -0,0 +1,353 @@
+#include "UICompress.h"
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+
+/*
+ * ----------
+ * | Blocks |
+ * ----------
+ */
+
+// a 4x4 block of n channel texels, edges clamped
+template<uint32_t n>
+static void fetchBlock(const unsigned char* src, uint32_t width, uint32_t height, uint32_t bx, uint32_t by, unsigned char out[16][n]) {
+	for (uint32_t y = 0; y < 4; y++) {
+		uint32_t sy = std::min(by * 4 + y, height - 1);
+		for (uint32_t x = 0; x < 4; x++) {
+			uint32_t sx = std::min(bx * 4 + x, width - 1);
+			memcpy(out[y * 4 + x], src + ((size_t)sy * width + sx) * n, n);
+		}
+	}
+}
+
+template<uint32_t n>
+static void storeBlock(const unsigned char in[16][n], uint32_t width, uint32_t height, uint32_t bx, uint32_t by, unsigned char* dst) {
+	for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++)
+		for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++)
+			memcpy(dst + ((size_t)(by * 4 + y) * width + bx * 4 + x) * n, in[y * 4 + x], n);
+}
+
+/*
+ * -------
+ * | BC4 |
+ * -------
+ */
+
+// r0 > r1 gives 8 interpolated values, otherwise 6 plus 0 and 255
+static void paletteBC4(unsigned char r0, unsigned char r1, unsigned char p[8]) {
+	p[0] = r0;
+	p[1] = r1;
+	if (r0 > r1) for (uint32_t i = 1; i < 7; i++) p[i + 1] = ((7 - i) * r0 + i * r1 + 3) / 7;
+	else {
+		for (uint32_t i = 1; i < 5; i++) p[i + 1] = ((5 - i) * r0 + i * r1 + 2) / 5;
+		p[6] = 0;
+		p[7] = 255;
+	}
+}
+
+// returns the squared error, leaving the block in out
+static uint32_t tryBC4(const unsigned char v[16], unsigned char r0, unsigned char r1, unsigned char out[8]) {
+	unsigned char p[8];
+	paletteBC4(r0, r1, p);
+	uint64_t bits = 0;
+	uint32_t err = 0;
+	for (uint32_t i = 0; i < 16; i++) {
+		uint32_t best = 0, besterr = UINT32_MAX;
+		for (uint32_t j = 0; j < 8; j++) {
+			int32_t d = (int32_t)v[i] - p[j];
+			if ((uint32_t)(d * d) < besterr) {
+				besterr = d * d;
+				best = j;
+			}
+		}
+		err += besterr;
+		bits |= (uint64_t)best << (i * 3);
+	}
+	out[0] = r0;
+	out[1] = r1;
+	for (uint32_t i = 0; i < 6; i++) out[i + 2] = (bits >> (i * 8)) & 0xff;
+	return err;
+}
+
+static void encodeBlockBC4(const unsigned char v[16], unsigned char out[8]) {
+	unsigned char lo = 255, hi = 0, midlo = 255, midhi = 0;
+	for (uint32_t i = 0; i < 16; i++) {
+		lo = std::min(lo, v[i]);
+		hi = std::max(hi, v[i]);
+		// text coverage is mostly 0 and 255, which the 6 value mode gets for free
+		if (v[i] != 0 && v[i] != 255) {
+			midlo = std::min(midlo, v[i]);
+			midhi = std::max(midhi, v[i]);
+		}
+	}
+	if (lo == hi) {
+		tryBC4(v, lo, hi, out);
+		return;
+	}
+	unsigned char alt[8];
+	uint32_t err = tryBC4(v, hi, lo, out);
+	if (midlo > midhi) midlo = midhi = 0;
+	if (err && tryBC4(v, midlo, midhi, alt) < err) memcpy(out, alt, 8);
+}
+
+static void decodeBlockBC4(const unsigned char in[8], unsigned char out[16][1]) {
+	unsigned char p[8];
+	paletteBC4(in[0], in[1], p);
+	uint64_t bits = 0;
+	for (uint32_t i = 0; i < 6; i++) bits |= (uint64_t)in[i + 2] << (i * 8);
+	for (uint32_t i = 0; i < 16; i++) out[i][0] = p[(bits >> (i * 3)) & 7];
+}
+
+/*
+ * -------
+ * | BC1 |
+ * -------
+ */
+
+static uint16_t pack565(const float c[3]) {
+	uint32_t r = std::clamp(c[0], 0.0f, 255.0f) * 31 / 255 + 0.5f;
+	uint32_t g = std::clamp(c[1], 0.0f, 255.0f) * 63 / 255 + 0.5f;
+	uint32_t b = std::clamp(c[2], 0.0f, 255.0f) * 31 / 255 + 0.5f;
+	return (r << 11) | (g << 5) | b;
+}
+
+static void unpack565(uint16_t c, int32_t out[3]) {
+	uint32_t r = c >> 11, g = (c >> 5) & 63, b = c & 31;
+	out[0] = (r << 3) | (r >> 2);
+	out[1] = (g << 2) | (g >> 4);
+	out[2] = (b << 3) | (b >> 2);
+}
+
+// always the 4 color mode, which is all BC3 has and what the encoder keeps to
+static void paletteBC1(uint16_t c0, uint16_t c1, int32_t p[4][3]) {
+	unpack565(c0, p[0]);
+	unpack565(c1, p[1]);
+	for (uint32_t k = 0; k < 3; k++) {
+		p[2][k] = (2 * p[0][k] + p[1][k] + 1) / 3;
+		p[3][k] = (p[0][k] + 2 * p[1][k] + 1) / 3;
+	}
+}
+
+// picks indices for c0 and c1, returning the squared error
+static uint32_t fitBC1(const unsigned char v[16][4], uint16_t c0, uint16_t c1, uint32_t& indices) {
+	int32_t p[4][3];
+	paletteBC1(c0, c1, p);
+	uint32_t err = 0;
+	indices = 0;
+	for (uint32_t i = 0; i < 16; i++) {
+		uint32_t best = 0, besterr = UINT32_MAX;
+		for (uint32_t j = 0; j < 4; j++) {
+			uint32_t e = 0;
+			for (uint32_t k = 0; k < 3; k++) e += (v[i][k] - p[j][k]) * (v[i][k] - p[j][k]);
+			if (e < besterr) {
+				besterr = e;
+				best = j;
+			}
+		}
+		err += besterr;
+		indices |= best << (i * 2);
+	}
+	return err;
+}
+
+// keeps c0 > c1 so decoders use 4 colors, c0 == c1 only happens for flat blocks
+static uint32_t orderedFitBC1(const unsigned char v[16][4], uint16_t c0, uint16_t c1, uint16_t& o0, uint16_t& o1, uint32_t& indices) {
+	if (c0 < c1) std::swap(c0, c1);
+	o0 = c0;
+	o1 = c1;
+	if (c0 == c1) {
+		indices = 0;
+		int32_t p[3];
+		unpack565(c0, p);
+		uint32_t err = 0;
+		for (uint32_t i = 0; i < 16; i++) for (uint32_t k = 0; k < 3; k++) err += (v[i][k] - p[k]) * (v[i][k] - p[k]);
+		return err;
+	}
+	return fitBC1(v, c0, c1, indices);
+}
+
+// endpoints from the extremes along the principal axis, then one least squares refinement
+static void encodeBlockBC1(const unsigned char v[16][4], unsigned char out[8]) {
+	float mean[3] = {0, 0, 0}, lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0};
+	for (uint32_t i = 0; i < 16; i++) for (uint32_t k = 0; k < 3; k++) {
+		mean[k] += v[i][k] / 16.0f;
+		lo[k] = std::min(lo[k], (float)v[i][k]);
+		hi[k] = std::max(hi[k], (float)v[i][k]);
+	}
+	float cov[6] = {0, 0, 0, 0, 0, 0};
+	for (uint32_t i = 0; i < 16; i++) {
+		float d[3] = {v[i][0] - mean[0], v[i][1] - mean[1], v[i][2] - mean[2]};
+		cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+		cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+	}
+	float axis[3] = {hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]};
+	for (uint32_t it = 0; it < 4; it++) {
+		float a[3] = {
+			cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+			cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+			cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]};
+		float m = std::max({std::abs(a[0]), std::abs(a[1]), std::abs(a[2])});
+		if (m == 0) break;
+		for (uint32_t k = 0; k < 3; k++) axis[k] = a[k] / m;
+	}
+	uint32_t imin = 0, imax = 0;
+	float pmin = 1e30f, pmax = -1e30f;
+	for (uint32_t i = 0; i < 16; i++) {
+		float p = v[i][0] * axis[0] + v[i][1] * axis[1] + v[i][2] * axis[2];
+		if (p < pmin) {
+			pmin = p;
+			imin = i;
+		}
+		if (p > pmax) {
+			pmax = p;
+			imax = i;
+		}
+	}
+	float e0[3] = {(float)v[imax][0], (float)v[imax][1], (float)v[imax][2]};
+	float e1[3] = {(float)v[imin][0], (float)v[imin][1], (float)v[imin][2]};
+	uint16_t c0, c1;
+	uint32_t indices;
+	uint32_t err = orderedFitBC1(v, pack565(e0), pack565(e1), c0, c1, indices);
+
+	if (err && c0 != c1) {
+		// weights of c0 for each index, solve for the endpoints minimizing the error of these assignments
+		static const float weights[4] = {1, 0, 2 / 3.0f, 1 / 3.0f};
+		float aa = 0, ab = 0, bb = 0, ax[3] = {0, 0, 0}, bx[3] = {0, 0, 0};
+		for (uint32_t i = 0; i < 16; i++) {
+			float a = weights[(indices >> (i * 2)) & 3], b = 1 - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (uint32_t k = 0; k < 3; k++) {
+				ax[k] += a * v[i][k];
+				bx[k] += b * v[i][k];
+			}
+		}
+		float det = aa * bb - ab * ab;
+		if (std::abs(det) > 1e-6f) {
+			float r0[3], r1[3];
+			for (uint32_t k = 0; k < 3; k++) {
+				r0[k] = (ax[k] * bb - bx[k] * ab) / det;
+				r1[k] = (bx[k] * aa - ax[k] * ab) / det;
+			}
+			uint16_t n0, n1;
+			uint32_t nindices;
+			if (orderedFitBC1(v, pack565(r0), pack565(r1), n0, n1, nindices) < err) {
+				c0 = n0;
+				c1 = n1;
+				indices = nindices;
+			}
+		}
+	}
+	out[0] = c0 & 0xff;
+	out[1] = c0 >> 8;
+	out[2] = c1 & 0xff;
+	out[3] = c1 >> 8;
+	for (uint32_t i = 0; i < 4; i++) out[i + 4] = (indices >> (i * 8)) & 0xff;
+}
+
+static void decodeBlockBC1(const unsigned char in[8], unsigned char out[16][4]) {
+	int32_t p[4][3];
+	paletteBC1(in[0] | (in[1] << 8), in[2] | (in[3] << 8), p);
+	uint32_t indices = in[4] | (in[5] << 8) | (in[6] << 16) | ((uint32_t)in[7] << 24);
+	for (uint32_t i = 0; i < 16; i++) {
+		const int32_t* c = p[(indices >> (i * 2)) & 3];
+		for (uint32_t k = 0; k < 3; k++) out[i][k] = c[k];
+		out[i][3] = 255;
+	}
+}
+
+/*
+ * ----------
+ * | Public |
+ * ----------
+ */
+
+std::vector<unsigned char> UIEncodeBC4(const unsigned char* r8, uint32_t width, uint32_t height) {
+	if (!width || !height) return {};
+	uint32_t bw = (width + 3) / 4, bh = (height + 3) / 4;
+	std::vector<unsigned char> result((size_t)bw * bh * 8);
+	unsigned char block[16][1], flat[16];
+	for (uint32_t by = 0; by < bh; by++) {
+		for (uint32_t bx = 0; bx < bw; bx++) {
+			fetchBlock<1>(r8, width, height, bx, by, block);
+			for (uint32_t i = 0; i < 16; i++) flat[i] = block[i][0];
+			encodeBlockBC4(flat, &result[((size_t)by * bw + bx) * 8]);
+		}
+	}
+	return result;
+}
+
+std::vector<unsigned char> UIEncodeBC1(const unsigned char* rgba, uint32_t width, uint32_t height) {
+	if (!width || !height) return {};
+	uint32_t bw = (width + 3) / 4, bh = (height + 3) / 4;
+	std::vector<unsigned char> result((size_t)bw * bh * 8);
+	unsigned char block[16][4];
+	for (uint32_t by = 0; by < bh; by++) {
+		for (uint32_t bx = 0; bx < bw; bx++) {
+			fetchBlock<4>(rgba, width, height, bx, by, block);
+			encodeBlockBC1(block, &result[((size_t)by * bw + bx) * 8]);
+		}
+	}
+	return result;
+}
+
+std::vector<unsigned char> UIEncodeBC3(const unsigned char* rgba, uint32_t width, uint32_t height) {
+	if (!width || !height) return {};
+	uint32_t bw = (width + 3) / 4, bh = (height + 3) / 4;
+	std::vector<unsigned char> result((size_t)bw * bh * 16);
+	unsigned char block[16][4], alpha[16];
+	for (uint32_t by = 0; by < bh; by++) {
+		for (uint32_t bx = 0; bx < bw; bx++) {
+			fetchBlock<4>(rgba, width, height, bx, by, block);
+			unsigned char* out = &result[((size_t)by * bw + bx) * 16];
+			for (uint32_t i = 0; i < 16; i++) alpha[i] = block[i][3];
+			encodeBlockBC4(alpha, out);
+			encodeBlockBC1(block, out + 8);
+		}
+	}
+	return result;
+}
+
+std::vector<unsigned char> UIDecodeBC4(const unsigned char* blocks, uint32_t width, uint32_t height) {
+	uint32_t bw = (width + 3) / 4, bh = (height + 3) / 4;
+	std::vector<unsigned char> result((size_t)width * height);
+	unsigned char block[16][1];
+	for (uint32_t by = 0; by < bh; by++) {
+		for (uint32_t bx = 0; bx < bw; bx++) {
+			decodeBlockBC4(blocks + ((size_t)by * bw + bx) * 8, block);
+			storeBlock<1>(block, width, height, bx, by, result.data());
+		}
+	}
+	return result;
+}
+
+std::vector<unsigned char> UIDecodeBC1(const unsigned char* blocks, uint32_t width, uint32_t height) {
+	uint32_t bw = (width + 3) / 4, bh = (height + 3) / 4;
+	std::vector<unsigned char> result((size_t)width * height * 4);
+	unsigned char block[16][4];
+	for (uint32_t by = 0; by < bh; by++) {
+		for (uint32_t bx = 0; bx < bw; bx++) {
+			decodeBlockBC1(blocks + ((size_t)by * bw + bx) * 8, block);
+			storeBlock<4>(block, width, height, bx, by, result.data());
+		}
+	}
+	return result;
+}
+
+std::vector<unsigned char> UIDecodeBC3(const unsigned char* blocks, uint32_t width, uint32_t height) {
+	uint32_t bw = (width + 3) / 4, bh = (height + 3) / 4;
+	std::vector<unsigned char> result((size_t)width * height * 4);
+	unsigned char block[16][4], alpha[16][1];
+	for (uint32_t by = 0; by < bh; by++) {
+		for (uint32_t bx = 0; bx < bw; bx++) {
+			const unsigned char* in = blocks + ((size_t)by * bw + bx) * 16;
+			decodeBlockBC4(in, alpha);
+			decodeBlockBC1(in + 8, block);
+			for (uint32_t i = 0; i < 16; i++) block[i][3] = alpha[i][0];
+			storeBlock<4>(block, width, height, bx, by, result.data());
+		}
+	}
+	return result;
+}
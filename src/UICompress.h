@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Small CPU block-compression encoders (and decoders, for UISoftwareRenderer and checking), so large textures
+ * take less VRAM and upload bandwidth. Input rows start at the bottom like every other UI texture, extents
+ * needn't be multiples of 4 (edge blocks repeat the last row/column). Output is block-compressed data ready
+ * for a VK_FORMAT_BC*_BLOCK image of the same extent.
+ */
+
+// single channel, e.g. text coverage in VK_FORMAT_R8_UNORM, to VK_FORMAT_BC4_UNORM_BLOCK (2:1)
+std::vector<unsigned char> UIEncodeBC4(const unsigned char* r8, uint32_t width, uint32_t height);
+// opaque RGBA8 to VK_FORMAT_BC1_RGB_UNORM_BLOCK (8:1), alpha is ignored
+std::vector<unsigned char> UIEncodeBC1(const unsigned char* rgba, uint32_t width, uint32_t height);
+// RGBA8 to VK_FORMAT_BC3_UNORM_BLOCK (4:1), i.e. BC1 color plus BC4 alpha
+std::vector<unsigned char> UIEncodeBC3(const unsigned char* rgba, uint32_t width, uint32_t height);
+
+// back to R8 for BC4, RGBA8 for BC1 and BC3
+std::vector<unsigned char> UIDecodeBC4(const unsigned char* blocks, uint32_t width, uint32_t height);
+std::vector<unsigned char> UIDecodeBC1(const unsigned char* blocks, uint32_t width, uint32_t height);
+std::vector<unsigned char> UIDecodeBC3(const unsigned char* blocks, uint32_t width, uint32_t height);
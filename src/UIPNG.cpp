@@ -0,0 +1,310 @@
+#include "UIPNG.h"
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+/*
+ * -----------
+ * | Inflate |
+ * -----------
+ */
+
+// canonical Huffman code, decoded a bit at a time as in zlib's puff.c
+typedef struct Huffman {
+	uint16_t count[16];
+	uint16_t symbol[288];
+} Huffman;
+
+typedef struct InflateState {
+	const unsigned char* in;
+	size_t insize, inpos;
+	uint32_t bitbuf, bitcnt;
+	std::vector<unsigned char>* out;
+	// out can't grow past this, so a small stream can't inflate to gigabytes
+	size_t outlimit;
+	bool error;
+} InflateState;
+
+static const uint16_t lengthbase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint16_t lengthextra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t distbase[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+	4097, 6145, 8193, 12289, 16385, 24577};
+static const uint16_t distextra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const uint8_t codelengthorder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+static uint32_t getBits(InflateState& s, uint32_t n) {
+	while (s.bitcnt < n) {
+		if (s.inpos >= s.insize) {
+			s.error = true;
+			return 0;
+		}
+		s.bitbuf |= (uint32_t)s.in[s.inpos++] << s.bitcnt;
+		s.bitcnt += 8;
+	}
+	uint32_t result = s.bitbuf & ((1ull << n) - 1);
+	s.bitbuf >>= n;
+	s.bitcnt -= n;
+	return result;
+}
+
+static bool buildHuffman(Huffman& h, const uint8_t* lengths, uint32_t n) {
+	uint16_t offsets[16];
+	memset(h.count, 0, sizeof(h.count));
+	for (uint32_t i = 0; i < n; i++) h.count[lengths[i]]++;
+	h.count[0] = 0;
+	int32_t left = 1;
+	for (uint32_t len = 1; len < 16; len++) {
+		left = (left << 1) - h.count[len];
+		// over-subscribed
+		if (left < 0) return false;
+	}
+	offsets[1] = 0;
+	for (uint32_t len = 1; len < 15; len++) offsets[len + 1] = offsets[len] + h.count[len];
+	for (uint32_t i = 0; i < n; i++) if (lengths[i]) h.symbol[offsets[lengths[i]]++] = i;
+	return true;
+}
+
+static int32_t decodeSymbol(InflateState& s, const Huffman& h) {
+	int32_t code = 0, first = 0, index = 0, count;
+	for (uint32_t len = 1; len < 16; len++) {
+		code |= getBits(s, 1);
+		count = h.count[len];
+		if (code - count < first) return h.symbol[index + (code - first)];
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	s.error = true;
+	return -1;
+}
+
+static bool inflateCodes(InflateState& s, const Huffman& lencode, const Huffman& distcode) {
+	int32_t symbol;
+	uint32_t len, dist;
+	std::vector<unsigned char>& out = *s.out;
+	while (!s.error) {
+		symbol = decodeSymbol(s, lencode);
+		if (symbol < 0) return false;
+		if (symbol < 256) {
+			if (out.size() >= s.outlimit) return false;
+			out.push_back(symbol);
+		}
+		else if (symbol == 256) return true;
+		else {
+			symbol -= 257;
+			if (symbol >= 29) return false;
+			len = lengthbase[symbol] + getBits(s, lengthextra[symbol]);
+			symbol = decodeSymbol(s, distcode);
+			if (symbol < 0 || symbol >= 30) return false;
+			dist = distbase[symbol] + getBits(s, distextra[symbol]);
+			if (dist > out.size() || len > s.outlimit - out.size()) return false;
+			// may overlap, so no memcpy
+			for (size_t from = out.size() - dist; len > 0; len--) out.push_back(out[from++]);
+		}
+	}
+	return false;
+}
+
+static bool inflateStored(InflateState& s) {
+	s.bitbuf = 0;
+	s.bitcnt = 0;
+	if (s.inpos + 4 > s.insize) return false;
+	const uint32_t len = s.in[s.inpos] | (s.in[s.inpos + 1] << 8),
+		nlen = s.in[s.inpos + 2] | (s.in[s.inpos + 3] << 8);
+	s.inpos += 4;
+	if (len != (~nlen & 0xffff) || s.inpos + len > s.insize || len > s.outlimit - s.out->size()) return false;
+	s.out->insert(s.out->end(), s.in + s.inpos, s.in + s.inpos + len);
+	s.inpos += len;
+	return true;
+}
+
+static bool inflateFixed(InflateState& s) {
+	static Huffman lencode, distcode;
+	// thread-safe, function-local statics are only initialized once
+	static const bool built = [] () {
+		uint8_t lengths[288];
+		uint32_t i = 0;
+		for (; i < 144; i++) lengths[i] = 8;
+		for (; i < 256; i++) lengths[i] = 9;
+		for (; i < 280; i++) lengths[i] = 7;
+		for (; i < 288; i++) lengths[i] = 8;
+		buildHuffman(lencode, lengths, 288);
+		for (i = 0; i < 30; i++) lengths[i] = 5;
+		buildHuffman(distcode, lengths, 30);
+		return true;
+	}();
+	(void)built;
+	return inflateCodes(s, lencode, distcode);
+}
+
+static bool inflateDynamic(InflateState& s) {
+	uint8_t lengths[320];
+	Huffman lencode, distcode;
+	const uint32_t nlen = getBits(s, 5) + 257, ndist = getBits(s, 5) + 1, ncode = getBits(s, 4) + 4;
+	if (s.error || nlen > 286 || ndist > 30) return false;
+	memset(lengths, 0, sizeof(lengths));
+	for (uint32_t i = 0; i < ncode; i++) lengths[codelengthorder[i]] = getBits(s, 3);
+	if (!buildHuffman(lencode, lengths, 19)) return false;
+
+	int32_t symbol;
+	uint32_t repeat;
+	uint8_t prev;
+	for (uint32_t i = 0; i < nlen + ndist;) {
+		symbol = decodeSymbol(s, lencode);
+		if (symbol < 0) return false;
+		if (symbol < 16) lengths[i++] = symbol;
+		else {
+			prev = 0;
+			if (symbol == 16) {
+				if (i == 0) return false;
+				prev = lengths[i - 1];
+				repeat = 3 + getBits(s, 2);
+			}
+			else if (symbol == 17) repeat = 3 + getBits(s, 3);
+			else repeat = 11 + getBits(s, 7);
+			if (i + repeat > nlen + ndist) return false;
+			while (repeat--) lengths[i++] = prev;
+		}
+	}
+	if (s.error || lengths[256] == 0) return false;
+	if (!buildHuffman(lencode, lengths, nlen) || !buildHuffman(distcode, lengths + nlen, ndist)) return false;
+	return inflateCodes(s, lencode, distcode);
+}
+
+// zlib stream (as in IDAT), adler32 isn't checked, fails if out would grow past outlimit
+static bool zlibInflate(const unsigned char* in, size_t insize, std::vector<unsigned char>& out, size_t outlimit) {
+	if (insize < 2 || (in[0] & 0x0f) != 8 || ((in[0] << 8) | in[1]) % 31 || (in[1] & 0x20)) return false;
+	InflateState s = {in, insize, 2, 0, 0, &out, outlimit, false};
+	uint32_t last, type;
+	do {
+		last = getBits(s, 1);
+		type = getBits(s, 2);
+		if (s.error) return false;
+		if (type == 0 && !inflateStored(s)) return false;
+		else if (type == 1 && !inflateFixed(s)) return false;
+		else if (type == 2 && !inflateDynamic(s)) return false;
+		else if (type == 3) return false;
+	} while (!last);
+	return true;
+}
+
+/*
+ * -------
+ * | PNG |
+ * -------
+ */
+
+static uint32_t readBE32(const unsigned char* p) {
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static unsigned char paeth(int32_t a, int32_t b, int32_t c) {
+	const int32_t p = a + b - c, pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+	if (pa <= pb && pa <= pc) return a;
+	return pb <= pc ? b : c;
+}
+
+bool UIDecodePNG(const unsigned char* data, size_t size, std::vector<unsigned char>& rgba, uint32_t& width, uint32_t& height) {
+	static const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+	if (size < 8 || memcmp(data, signature, 8)) return false;
+
+	uint32_t bitdepth = 0, colortype = 0, interlace = 0;
+	std::vector<unsigned char> idat, palette, trns;
+	width = 0;
+	height = 0;
+	for (size_t pos = 8; pos + 12 <= size;) {
+		const uint32_t len = readBE32(data + pos);
+		const unsigned char* type = data + pos + 4, * chunk = data + pos + 8;
+		if (len > size - pos - 12) return false;
+		if (!memcmp(type, "IHDR", 4) && len >= 13) {
+			width = readBE32(chunk);
+			height = readBE32(chunk + 4);
+			bitdepth = chunk[8];
+			colortype = chunk[9];
+			interlace = chunk[12];
+		}
+		else if (!memcmp(type, "PLTE", 4)) palette.assign(chunk, chunk + len);
+		else if (!memcmp(type, "tRNS", 4)) trns.assign(chunk, chunk + len);
+		else if (!memcmp(type, "IDAT", 4)) idat.insert(idat.end(), chunk, chunk + len);
+		else if (!memcmp(type, "IEND", 4)) break;
+		pos += 12 + len;
+	}
+	// TODO: Adam7
+	if (width == 0 || height == 0 || interlace != 0 || (uint64_t)width * height > UI_PNG_MAX_PIXELS) return false;
+
+	uint32_t channels;
+	switch (colortype) {
+		case 0: channels = 1; break;
+		case 2: channels = 3; break;
+		case 3: channels = 1; break;
+		case 4: channels = 2; break;
+		case 6: channels = 4; break;
+		default: return false;
+	}
+	if (bitdepth != 1 && bitdepth != 2 && bitdepth != 4 && bitdepth != 8 && bitdepth != 16) return false;
+	if ((colortype == 2 || colortype == 4 || colortype == 6) && bitdepth < 8) return false;
+	if (colortype == 3 && (bitdepth == 16 || palette.empty())) return false;
+
+	const size_t stride = ((size_t)width * channels * bitdepth + 7) / 8,
+		bpp = std::max<size_t>(1, channels * bitdepth / 8);
+	std::vector<unsigned char> raw;
+	// trusting the header alone would let a tiny file allocate gigabytes before inflate finds it's short
+	raw.reserve(std::min((stride + 1) * height, idat.size() * 8));
+	if (!zlibInflate(idat.data(), idat.size(), raw, (stride + 1) * height) || raw.size() < (stride + 1) * height) return false;
+
+	// unfilter in place, each row is preceded by its filter type
+	unsigned char* prev = nullptr, * row;
+	for (uint32_t y = 0; y < height; y++) {
+		row = &raw[y * (stride + 1) + 1];
+		const unsigned char filter = row[-1];
+		for (size_t x = 0; x < stride; x++) {
+			const unsigned char a = x >= bpp ? row[x - bpp] : 0,
+				b = prev ? prev[x] : 0,
+				c = prev && x >= bpp ? prev[x - bpp] : 0;
+			switch (filter) {
+				case 0: break;
+				case 1: row[x] += a; break;
+				case 2: row[x] += b; break;
+				case 3: row[x] += (a + b) / 2; break;
+				case 4: row[x] += paeth(a, b, c); break;
+				default: return false;
+			}
+		}
+		prev = row;
+	}
+
+	rgba.resize((size_t)width * height * 4);
+	auto sample = [bitdepth] (const unsigned char* row, size_t idx) -> uint32_t {
+		// idx-th sample in the row, in its original bit depth (16-bit truncated to 8)
+		if (bitdepth == 8) return row[idx];
+		if (bitdepth == 16) return row[idx * 2];
+		const size_t bit = idx * bitdepth;
+		return (row[bit / 8] >> (8 - bitdepth - bit % 8)) & ((1 << bitdepth) - 1);
+	};
+	const uint32_t graymax = (1 << std::min(bitdepth, 8u)) - 1;
+	unsigned char* dst = rgba.data();
+	for (uint32_t y = 0; y < height; y++) {
+		row = &raw[y * (stride + 1) + 1];
+		for (uint32_t x = 0; x < width; x++, dst += 4) {
+			if (colortype == 3) {
+				const uint32_t i = sample(row, x);
+				if ((size_t)i * 3 + 2 >= palette.size()) return false;
+				memcpy(dst, &palette[i * 3], 3);
+				dst[3] = i < trns.size() ? trns[i] : 255;
+			}
+			else if (colortype == 0 || colortype == 4) {
+				dst[0] = dst[1] = dst[2] = sample(row, x * channels) * 255 / graymax;
+				dst[3] = colortype == 4 ? sample(row, x * channels + 1) : 255;
+			}
+			else {
+				for (uint32_t ch = 0; ch < 3; ch++) dst[ch] = sample(row, x * channels + ch);
+				dst[3] = colortype == 6 ? sample(row, x * channels + 3) : 255;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// larger images are refused before anything is allocated for them, 64M pixels is 256MB of RGBA
+#ifndef UI_PNG_MAX_PIXELS
+#define UI_PNG_MAX_PIXELS (1ull << 26)
+#endif
+
+/*
+ * Small self-contained PNG decoder (inflate included), so loading images doesn't need another dependency.
+ * Handles every non-interlaced color type and bit depth, plus palette transparency; 16-bit channels are
+ * truncated to 8. Always outputs 8-bit RGBA, top row first. Returns false on anything it can't decode,
+ * including images over UI_PNG_MAX_PIXELS and image data that inflates to more than the image needs.
+ * Thread-safe.
+ */
+bool UIDecodePNG(const unsigned char* data, size_t size, std::vector<unsigned char>& rgba, uint32_t& width, uint32_t& height);
@@ -0,0 +1,259 @@
+#include "UIPipeline.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+// generated by build/EmbedSPIRV.cmake, defining UIVertexSPIRV and UIFragmentSPIRV
+#ifdef UI_EMBEDDED_SHADERS
+#include "UIVertex.h"
+#include "UIFragment.h"
+#endif
+
+/*
+ * ---------------------
+ * | UIPipelineBuilder |
+ * ---------------------
+ */
+
+const VkDescriptorSetLayoutBinding UIPipelineBuilder::texbinding = {
+	.binding = 0,
+	.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+	.descriptorCount = 1,
+	.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+	.pImmutableSamplers = nullptr
+};
+
+// -- Public --
+
+UIPipelineBuilder::UIPipelineBuilder(VkPhysicalDevice pd, VkDevice d, std::string cachepath) :
+		device(d),
+		deviceprops({}),
+		cachepath(cachepath),
+		cache(VK_NULL_HANDLE),
+		vertmodule(VK_NULL_HANDLE),
+		fragmodule(VK_NULL_HANDLE),
+		stats({}) {
+	vkGetPhysicalDeviceProperties(pd, &deviceprops);
+
+	std::vector<unorm> blob;
+	if (!cachepath.empty()) {
+		FILE* f = fopen(cachepath.c_str(), "rb");
+		if (f) {
+			unorm buf[16384];
+			size_t n;
+			while ((n = fread(buf, 1, sizeof(buf), f)) > 0) blob.insert(blob.end(), buf, buf + n);
+			fclose(f);
+		}
+		// drivers should reject a stale cache themselves, but not all do so gracefully
+		if (!compatibleCache(blob)) blob.clear();
+	}
+	stats.cacheloaded = !blob.empty();
+	stats.cachebytes = blob.size();
+	VkPipelineCacheCreateInfo cacheci = {};
+	cacheci.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cacheci.initialDataSize = blob.size();
+	cacheci.pInitialData = blob.empty() ? nullptr : blob.data();
+	if (vkCreatePipelineCache(device, &cacheci, nullptr, &cache) != VK_SUCCESS) cache = VK_NULL_HANDLE;
+
+#ifdef UI_EMBEDDED_SHADERS
+	vertmodule = createModule(UIVertexSPIRV, sizeof(UIVertexSPIRV));
+	fragmodule = createModule(UIFragmentSPIRV, sizeof(UIFragmentSPIRV));
+#endif
+}
+
+UIPipelineBuilder::~UIPipelineBuilder() {
+	saveCache();
+	if (vertmodule != VK_NULL_HANDLE) vkDestroyShaderModule(device, vertmodule, nullptr);
+	if (fragmodule != VK_NULL_HANDLE) vkDestroyShaderModule(device, fragmodule, nullptr);
+	if (cache != VK_NULL_HANDLE) vkDestroyPipelineCache(device, cache, nullptr);
+}
+
+bool UIPipelineBuilder::hasEmbeddedShaders() {
+#ifdef UI_EMBEDDED_SHADERS
+	return true;
+#else
+	return false;
+#endif
+}
+
+UIPipelineInfo UIPipelineBuilder::build(VkRenderPass rp, uint32_t subpass, VkSampleCountFlagBits samples) {
+	UIPipelineInfo result;
+	result.specinfo = nullptr;
+	// SCREEN_WIDTH and SCREEN_HEIGHT in UIVertex.glsl, which divides by them
+	const VkExtent2D screen = UIComponent::getScreenExtent();
+	if (vertmodule == VK_NULL_HANDLE || fragmodule == VK_NULL_HANDLE || screen.width == 0 || screen.height == 0) {
+		return result;
+	}
+	const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+	result.descsetlayoutci.bindingCount = 1;
+	result.descsetlayoutci.pBindings = &texbinding;
+	result.pushconstantrange = {
+		VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+		0,
+		sizeof(UIPushConstantData) + sizeof(UIChromeData)
+	};
+	VkPipelineLayoutCreateInfo layoutci = {};
+	layoutci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutci.setLayoutCount = 1;
+	layoutci.pSetLayouts = &result.dsl;
+	layoutci.pushConstantRangeCount = 1;
+	layoutci.pPushConstantRanges = &result.pushconstantrange;
+	if (vkCreateDescriptorSetLayout(device, &result.descsetlayoutci, nullptr, &result.dsl) != VK_SUCCESS
+		|| vkCreatePipelineLayout(device, &layoutci, nullptr, &result.layout) != VK_SUCCESS) {
+		destroy(result);
+		return result;
+	}
+
+	const float specdata[2] = {(float)screen.width, (float)screen.height};
+	const VkSpecializationMapEntry specentries[2] = {
+		{0, 0, sizeof(float)},
+		{1, sizeof(float), sizeof(float)}
+	};
+	const VkSpecializationInfo specinfo = {2, specentries, sizeof(specdata), specdata};
+	VkPipelineShaderStageCreateInfo stages[2] = {};
+	stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	stages[0].module = vertmodule;
+	stages[0].pName = "main";
+	stages[0].pSpecializationInfo = &specinfo;
+	stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	stages[1].module = fragmodule;
+	stages[1].pName = "main";
+	// quad corners come from gl_VertexIndex, so there's no vertex input
+	VkPipelineVertexInputStateCreateInfo vertexinput = {};
+	vertexinput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	VkPipelineInputAssemblyStateCreateInfo inputassembly = {};
+	inputassembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputassembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	inputassembly.primitiveRestartEnable = VK_FALSE;
+	VkPipelineViewportStateCreateInfo viewport = {};
+	viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewport.viewportCount = 1;
+	viewport.scissorCount = 1;
+	VkPipelineRasterizationStateCreateInfo rasterization = {};
+	rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterization.depthClampEnable = VK_FALSE;
+	rasterization.rasterizerDiscardEnable = VK_FALSE;
+	rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterization.cullMode = VK_CULL_MODE_NONE;
+	rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterization.depthBiasEnable = VK_FALSE;
+	rasterization.lineWidth = 1.f;
+	VkPipelineMultisampleStateCreateInfo multisample = {};
+	multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisample.rasterizationSamples = samples;
+	multisample.sampleShadingEnable = VK_FALSE;
+	// UI is drawn in painter's order, so depth is never tested or written
+	VkPipelineDepthStencilStateCreateInfo depthstencil = {};
+	depthstencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthstencil.depthTestEnable = VK_FALSE;
+	depthstencil.depthWriteEnable = VK_FALSE;
+	depthstencil.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+	depthstencil.depthBoundsTestEnable = VK_FALSE;
+	depthstencil.stencilTestEnable = VK_FALSE;
+	VkPipelineColorBlendAttachmentState blendattachment = {};
+	blendattachment.blendEnable = VK_TRUE;
+	blendattachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	blendattachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blendattachment.colorBlendOp = VK_BLEND_OP_ADD;
+	blendattachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	blendattachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blendattachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	blendattachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT
+		| VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+	VkPipelineColorBlendStateCreateInfo colorblend = {};
+	colorblend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorblend.logicOpEnable = VK_FALSE;
+	colorblend.attachmentCount = 1;
+	colorblend.pAttachments = &blendattachment;
+	// scissors are what makes UIComponent::takeDamage useful
+	const VkDynamicState dynamicstates[2] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+	VkPipelineDynamicStateCreateInfo dynamic = {};
+	dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamic.dynamicStateCount = 2;
+	dynamic.pDynamicStates = dynamicstates;
+	VkGraphicsPipelineCreateInfo pipelineci = {};
+	pipelineci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineci.stageCount = 2;
+	pipelineci.pStages = stages;
+	pipelineci.pVertexInputState = &vertexinput;
+	pipelineci.pInputAssemblyState = &inputassembly;
+	pipelineci.pViewportState = &viewport;
+	pipelineci.pRasterizationState = &rasterization;
+	pipelineci.pMultisampleState = &multisample;
+	pipelineci.pDepthStencilState = &depthstencil;
+	pipelineci.pColorBlendState = &colorblend;
+	pipelineci.pDynamicState = &dynamic;
+	pipelineci.layout = result.layout;
+	pipelineci.renderPass = rp;
+	pipelineci.subpass = subpass;
+	pipelineci.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineci.basePipelineIndex = -1;
+	if (vkCreateGraphicsPipelines(device, cache, 1, &pipelineci, nullptr, &result.pipeline) != VK_SUCCESS) {
+		result.pipeline = VK_NULL_HANDLE;
+		destroy(result);
+	}
+	stats.buildms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	return result;
+}
+
+void UIPipelineBuilder::destroy(UIPipelineInfo& p) {
+	if (p.pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, p.pipeline, nullptr);
+	if (p.layout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, p.layout, nullptr);
+	if (p.dsl != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, p.dsl, nullptr);
+	p.pipeline = VK_NULL_HANDLE;
+	p.layout = VK_NULL_HANDLE;
+	p.dsl = VK_NULL_HANDLE;
+}
+
+bool UIPipelineBuilder::saveCache() {
+	if (cachepath.empty() || cache == VK_NULL_HANDLE) return false;
+	size_t size = 0;
+	if (vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS || size == 0) return false;
+	std::vector<unorm> blob(size);
+	if (vkGetPipelineCacheData(device, cache, &size, blob.data()) != VK_SUCCESS) return false;
+	blob.resize(size);
+
+	// write then rename, so a crash mid-write can't leave a truncated cache behind
+	const std::string tmppath = cachepath + ".tmp";
+	FILE* f = fopen(tmppath.c_str(), "wb");
+	if (!f) return false;
+	bool result = fwrite(blob.data(), 1, blob.size(), f) == blob.size();
+	result = fclose(f) == 0 && result;
+	std::error_code err;
+	if (result) std::filesystem::rename(tmppath, cachepath, err);
+	if (!result || err) {
+		std::filesystem::remove(tmppath, err);
+		return false;
+	}
+	stats.cachebytes = blob.size();
+	return true;
+}
+
+// -- Private --
+
+bool UIPipelineBuilder::compatibleCache(const std::vector<unorm>& blob) const {
+	// VkPipelineCacheHeaderVersionOne, as it's laid out in the blob
+	const size_t headersize = 16 + VK_UUID_SIZE;
+	if (blob.size() < headersize) return false;
+	uint32_t header[4];
+	memcpy(header, blob.data(), sizeof(header));
+	return header[0] >= headersize
+		&& header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		&& header[2] == deviceprops.vendorID
+		&& header[3] == deviceprops.deviceID
+		&& !memcmp(blob.data() + 16, deviceprops.pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+VkShaderModule UIPipelineBuilder::createModule(const uint32_t* code, size_t size) {
+	VkShaderModuleCreateInfo moduleci = {};
+	moduleci.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	moduleci.codeSize = size;
+	moduleci.pCode = code;
+	VkShaderModule result;
+	if (vkCreateShaderModule(device, &moduleci, nullptr, &result) != VK_SUCCESS) return VK_NULL_HANDLE;
+	return result;
+}
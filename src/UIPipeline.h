@@ -0,0 +1,53 @@
+#pragma once
+
+#include "UI.h"
+
+typedef struct UIPipelineStats {
+	bool cacheloaded; // whether cachepath held a cache made by this device and driver
+	size_t cachebytes; // size of the cache as last loaded or saved
+	double buildms; // time the last build took
+} UIPipelineStats;
+
+/*
+ * Builds a UIPipelineInfo for the bundled shaders, ready for UIComponent::setDefaultGraphicsPipeline, from
+ * SPIR-V embedded in the library at build time, so no shader files are needed at runtime. Pipelines are
+ * created through a VkPipelineCache that's loaded from cachepath and saved back to it, letting later runs
+ * skip most pipeline compilation. Viewport and scissor are dynamic state, set them in your draw function.
+ */
+class UIPipelineBuilder {
+public:
+	// cachepath may be empty to not persist the cache
+	UIPipelineBuilder(VkPhysicalDevice pd, VkDevice d, std::string cachepath);
+	UIPipelineBuilder(const UIPipelineBuilder& rhs) = delete;
+	// saves the cache
+	~UIPipelineBuilder();
+
+	UIPipelineBuilder& operator=(const UIPipelineBuilder& rhs) = delete;
+
+	// false if the library was built without glslc available, in which case build always fails
+	static bool hasEmbeddedShaders();
+	/*
+	 * The screen extent is baked in as specialization constants, so rebuild after UIComponent::setScreenExtent
+	 * (the cache makes this cheap), and set it before the first build, which fails while it's 0x0. Returns a
+	 * UIPipelineInfo with a null pipeline on failure.
+	 */
+	UIPipelineInfo build(VkRenderPass rp, uint32_t subpass, VkSampleCountFlagBits samples);
+	// for UIPipelineInfos from build, once nothing is using them
+	void destroy(UIPipelineInfo& p);
+	bool saveCache();
+	const UIPipelineStats& getStats() const {return stats;}
+
+private:
+	VkDevice device;
+	VkPhysicalDeviceProperties deviceprops;
+	std::string cachepath;
+	VkPipelineCache cache;
+	VkShaderModule vertmodule, fragmodule;
+	UIPipelineStats stats;
+
+	static const VkDescriptorSetLayoutBinding texbinding;
+
+	// whether blob was written by this device and driver
+	bool compatibleCache(const std::vector<unorm>& blob) const;
+	VkShaderModule createModule(const uint32_t* code, size_t size);
+};
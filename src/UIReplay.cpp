@@ -0,0 +1,176 @@
+#include "UIReplay.h"
+#include <cstdio>
+#include <cstring>
+
+#define UI_REPLAY_MAGIC "UIIR"
+#define UI_REPLAY_VERSION 1
+// fixed point scale for stored positions
+#define UI_REPLAY_POS_SCALE 16.f
+// bytes in the smallest record, a click with no time since the last event
+#define UI_REPLAY_MIN_RECORD 2
+
+static void writeVarint(std::vector<unorm>& out, uint64_t x) {
+	while (x >= 0x80) {
+		out.push_back((unorm)(x | 0x80));
+		x >>= 7;
+	}
+	out.push_back((unorm)x);
+}
+
+static bool readVarint(const std::vector<unorm>& in, size_t& idx, uint64_t& x) {
+	x = 0;
+	for (uint32_t shift = 0; idx < in.size() && shift < 64; shift += 7) {
+		x |= (uint64_t)(in[idx] & 0x7f) << shift;
+		if (!(in[idx++] & 0x80)) return true;
+	}
+	return false;
+}
+
+static uint64_t zigzag(int64_t x) {return ((uint64_t)x << 1) ^ (uint64_t)(x >> 63);}
+static int64_t unzigzag(uint64_t x) {return (int64_t)(x >> 1) ^ -(int64_t)(x & 1);}
+
+/*
+ * -------------------
+ * | UIInputRecorder |
+ * -------------------
+ */
+
+// -- Public --
+
+void UIInputRecorder::recordMousePos(UICoord p) {
+	events.push_back({now(), UI_INPUT_EVENT_MOUSE_POS, p});
+}
+
+void UIInputRecorder::recordMouseClick(bool click) {
+	events.push_back({now(), click ? UI_INPUT_EVENT_MOUSE_PRESS : UI_INPUT_EVENT_MOUSE_RELEASE, {0, 0}});
+}
+
+void UIInputRecorder::clear() {
+	events.clear();
+	start = std::chrono::steady_clock::now();
+}
+
+bool UIInputRecorder::save(const char* path) const {
+	std::vector<unorm> out(UI_REPLAY_MAGIC, UI_REPLAY_MAGIC + 4);
+	writeVarint(out, UI_REPLAY_VERSION);
+	writeVarint(out, events.size());
+	uint64_t lasttime = 0;
+	int64_t lastx = 0, lasty = 0, x, y;
+	for (const UIInputEvent& e : events) {
+		out.push_back(e.type);
+		writeVarint(out, e.time - lasttime);
+		lasttime = e.time;
+		if (e.type == UI_INPUT_EVENT_MOUSE_POS) {
+			x = llroundf(e.pos.x * UI_REPLAY_POS_SCALE);
+			y = llroundf(e.pos.y * UI_REPLAY_POS_SCALE);
+			writeVarint(out, zigzag(x - lastx));
+			writeVarint(out, zigzag(y - lasty));
+			lastx = x;
+			lasty = y;
+		}
+	}
+	FILE* f = fopen(path, "wb");
+	if (!f) return false;
+	bool result = fwrite(out.data(), 1, out.size(), f) == out.size();
+	fclose(f);
+	return result;
+}
+
+std::vector<UIInputEvent> UIInputRecorder::load(const char* path) {
+	FILE* f = fopen(path, "rb");
+	if (!f) return {};
+	std::vector<unorm> in;
+	unorm buf[4096];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0) in.insert(in.end(), buf, buf + n);
+	fclose(f);
+
+	size_t idx = 4;
+	uint64_t version, count;
+	if (in.size() < 4 || memcmp(in.data(), UI_REPLAY_MAGIC, 4)
+		|| !readVarint(in, idx, version) || version != UI_REPLAY_VERSION
+		|| !readVarint(in, idx, count)
+		// each record is at least a type byte and a time byte, so a bigger count is corrupt
+		|| count > (in.size() - idx) / UI_REPLAY_MIN_RECORD) {
+		return {};
+	}
+	std::vector<UIInputEvent> result;
+	result.reserve(count);
+	UIInputEvent e = {0, UI_INPUT_EVENT_MOUSE_POS, {0, 0}};
+	uint64_t dt, dx, dy;
+	int64_t x = 0, y = 0;
+	for (uint64_t i = 0; i < count; i++) {
+		if (idx >= in.size() || in[idx] > UI_INPUT_EVENT_MOUSE_PRESS) return {};
+		e.type = (UIInputEventType)in[idx++];
+		if (!readVarint(in, idx, dt)) return {};
+		e.time += dt;
+		if (e.type == UI_INPUT_EVENT_MOUSE_POS) {
+			if (!readVarint(in, idx, dx) || !readVarint(in, idx, dy)) return {};
+			x += unzigzag(dx);
+			y += unzigzag(dy);
+			e.pos = UICoord((float)x, (float)y) / UI_REPLAY_POS_SCALE;
+		}
+		else e.pos = {0, 0};
+		result.push_back(e);
+	}
+	// records past count mean count is wrong
+	if (idx != in.size()) return {};
+	return result;
+}
+
+// -- Private --
+
+uint64_t UIInputRecorder::now() const {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * -----------------
+ * | UIInputReplay |
+ * -----------------
+ */
+
+// -- Public --
+
+UIReplayStats UIInputReplay::replay(
+		const std::vector<UIInputEvent>& events,
+		const std::vector<UIComponent*>& roots,
+		void* data) {
+	UIReplayStats result = {};
+	result.numevents = events.size();
+	if (events.empty()) return result;
+
+	const UIEventStats before = UIComponent::getEventStats();
+	std::vector<double> latencies;
+	latencies.reserve(events.size());
+	std::chrono::steady_clock::time_point t0;
+	for (const UIInputEvent& e : events) {
+		t0 = std::chrono::steady_clock::now();
+		for (UIComponent* r : roots) {
+			if (e.type == UI_INPUT_EVENT_MOUSE_POS) r->listenMousePos(e.pos, data);
+			else r->listenMouseClick(e.type == UI_INPUT_EVENT_MOUSE_PRESS, data);
+		}
+		latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+	}
+	const UIEventStats after = UIComponent::getEventStats();
+	result.callbacks = {
+		after.hover - before.hover,
+		after.hoverbegin - before.hoverbegin,
+		after.hoverend - before.hoverend,
+		after.click - before.click,
+		after.clickbegin - before.clickbegin,
+		after.clickend - before.clickend
+	};
+
+	for (double l : latencies) result.total += l;
+	result.mean = result.total / latencies.size();
+	std::sort(latencies.begin(), latencies.end());
+	auto percentile = [&latencies] (double p) {
+		return latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))];
+	};
+	result.p50 = percentile(0.5);
+	result.p90 = percentile(0.9);
+	result.p99 = percentile(0.99);
+	result.max = latencies.back();
+	return result;
+}
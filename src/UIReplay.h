@@ -0,0 +1,59 @@
+#pragma once
+
+#include "UI.h"
+#include <chrono>
+
+typedef enum UIInputEventType {
+	UI_INPUT_EVENT_MOUSE_POS =     0x00,
+	UI_INPUT_EVENT_MOUSE_RELEASE = 0x01,
+	UI_INPUT_EVENT_MOUSE_PRESS =   0x02
+} UIInputEventType;
+
+typedef struct UIInputEvent {
+	uint64_t time; // in us since recording started
+	UIInputEventType type;
+	UICoord pos; // only meaningful for UI_INPUT_EVENT_MOUSE_POS
+} UIInputEvent;
+
+// latencies are in us, for handling a single event on all roots
+typedef struct UIReplayStats {
+	size_t numevents;
+	double total, mean, p50, p90, p99, max;
+	UIEventStats callbacks;
+} UIReplayStats;
+
+/*
+ * Sits between your input handling and listenMousePos/listenMouseClick, recording what it's given.
+ * Files store time and position as deltas (position in 1/16ths of a pixel), so an event is usually ~4 bytes.
+ */
+class UIInputRecorder {
+public:
+	UIInputRecorder() : start(std::chrono::steady_clock::now()), events({}) {}
+
+	void recordMousePos(UICoord p);
+	void recordMouseClick(bool click);
+	const std::vector<UIInputEvent>& getEvents() const {return events;}
+	void clear();
+	bool save(const char* path) const;
+	// returns an empty vector if path can't be read, isn't a recording, or is truncated or corrupt
+	static std::vector<UIInputEvent> load(const char* path);
+
+private:
+	std::chrono::steady_clock::time_point start;
+	std::vector<UIInputEvent> events;
+
+	uint64_t now() const;
+};
+
+/*
+ * Feeds recorded events to roots as fast as possible (ignoring recorded timing), in order, through
+ * listenMousePos/listenMouseClick. Callback counts come from UIComponent::getEventStats, so anything else
+ * generating events during a replay will be counted too.
+ */
+class UIInputReplay {
+public:
+	static UIReplayStats replay(
+		const std::vector<UIInputEvent>& events,
+		const std::vector<UIComponent*>& roots,
+		void* data);
+};
@@ -0,0 +1,254 @@
+#include "UISoftware.h"
+#include "UICompress.h"
+#include <cstdio>
+#include <cstring>
+
+/*
+ * ----------------------
+ * | UISoftwareRenderer |
+ * ----------------------
+ */
+
+// -- Public --
+
+UISoftwareRenderer::UISoftwareRenderer(VkExtent2D e) :
+	extent(e),
+	pixels((size_t)e.width * e.height * 4, 0),
+	textures({}),
+	nexthandle(1) {}
+
+dfType UISoftwareRenderer::getDrawFunc() {
+	return [this] (const UIComponent* c, const VkCommandBuffer&) {
+		VkImage img = UIComponent::getNoTex().image;
+		if (const UIImageInfo* t = c->getTexInfo()) img = t->image;
+		drawQuad(c->getPCData(), c->getChrome(), img);
+	};
+}
+
+tfType UISoftwareRenderer::getTexLoadFunc() {
+	return [this] (UIImage* i, void* d) {
+		if (!d) return;
+		UIImageInfo info = i->getTex();
+		info.image = (VkImage)nexthandle++;
+		textures[info.image] = decode((unorm*)d, info.format, info.extent);
+		i->setTex(info);
+	};
+}
+
+tdfType UISoftwareRenderer::getTexDestroyFunc() {
+	return [this] (UIImage* i) {
+		textures.erase(i->getTex().image);
+	};
+}
+
+tufType UISoftwareRenderer::getTexUpdateFunc() {
+	return [this] (UIImage* i, void* d, VkRect2D r) {
+		auto t = textures.find(i->getTex().image);
+		if (t == textures.end() || !d) return;
+		const Texture src = decode((unorm*)d, i->getTex().format, r.extent);
+		const size_t ts = texelSize(src.format);
+		for (uint32_t y = 0; y < r.extent.height; y++) {
+			memcpy(
+				&t->second.data[((size_t)(r.offset.y + y) * t->second.extent.width + r.offset.x) * ts],
+				&src.data[(size_t)y * r.extent.width * ts],
+				r.extent.width * ts);
+		}
+	};
+}
+
+void UISoftwareRenderer::clear(UIColor c) {
+	const unorm rgba[4] = {
+		(unorm)(c.r * 255.f + 0.5f),
+		(unorm)(c.g * 255.f + 0.5f),
+		(unorm)(c.b * 255.f + 0.5f),
+		(unorm)(c.a * 255.f + 0.5f)
+	};
+	for (size_t i = 0; i < pixels.size(); i += 4) memcpy(&pixels[i], rgba, 4);
+}
+
+void UISoftwareRenderer::render(const std::vector<const UIComponent*>& roots, UIColor c) {
+	clear(c);
+	for (const UIComponent* r : roots) r->draw(VK_NULL_HANDLE);
+}
+
+void UISoftwareRenderer::renderDrawData(const std::vector<UIDrawData>& items, UIColor c) {
+	clear(c);
+	for (const UIDrawData& d : items) {
+		drawQuad(d.pcdata, d.chrome, d.pcdata.flags & UI_PC_FLAG_TEX ? d.image : UIComponent::getNoTex().image);
+	}
+}
+
+void UISoftwareRenderer::setNoTex(const unorm* data, VkExtent2D e, VkFormat f) {
+	UIImageInfo info;
+	info.image = (VkImage)nexthandle++;
+	info.extent = e;
+	info.format = f;
+	textures[info.image] = {e, f, std::vector<unorm>(data, data + (size_t)e.width * e.height * texelSize(f))};
+	UIComponent::setNoTex(info);
+}
+
+size_t UISoftwareRenderer::diff(const std::vector<unorm>& golden, unorm tolerance) const {
+	if (golden.size() != pixels.size()) return pixels.size() / 4;
+	size_t result = 0;
+	for (size_t i = 0; i < pixels.size(); i += 4) {
+		for (size_t ch = 0; ch < 4; ch++) {
+			if (abs((int)pixels[i + ch] - (int)golden[i + ch]) > tolerance) {
+				result++;
+				break;
+			}
+		}
+	}
+	return result;
+}
+
+bool UISoftwareRenderer::writePAM(const char* path) const {
+	FILE* f = fopen(path, "wb");
+	if (!f) return false;
+	fprintf(f, "P7\nWIDTH %u\nHEIGHT %u\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n",
+		extent.width, extent.height);
+	bool result = fwrite(pixels.data(), 1, pixels.size(), f) == pixels.size();
+	fclose(f);
+	return result;
+}
+
+std::vector<unorm> UISoftwareRenderer::readPAM(const char* path, VkExtent2D& e) {
+	FILE* f = fopen(path, "rb");
+	if (!f) return {};
+	uint32_t depth = 0, maxval = 0;
+	e = {0, 0};
+	char line[128];
+	while (fgets(line, sizeof(line), f) && strncmp(line, "ENDHDR", 6)) {
+		sscanf(line, "WIDTH %u", &e.width);
+		sscanf(line, "HEIGHT %u", &e.height);
+		sscanf(line, "DEPTH %u", &depth);
+		sscanf(line, "MAXVAL %u", &maxval);
+	}
+	std::vector<unorm> result;
+	if (depth == 4 && maxval == 255) {
+		result.resize((size_t)e.width * e.height * 4);
+		if (fread(result.data(), 1, result.size(), f) != result.size()) result.clear();
+	}
+	fclose(f);
+	return result;
+}
+
+// -- Private --
+
+UISoftwareRenderer::Texture UISoftwareRenderer::decode(const unorm* d, VkFormat f, VkExtent2D e) {
+	Texture t = {e, f, {}};
+	switch (f) {
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			t.format = VK_FORMAT_R8_UNORM;
+			t.data = UIDecodeBC4(d, e.width, e.height);
+			break;
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+			t.format = VK_FORMAT_R8G8B8A8_UNORM;
+			t.data = UIDecodeBC1(d, e.width, e.height);
+			break;
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+			t.format = VK_FORMAT_R8G8B8A8_UNORM;
+			t.data = UIDecodeBC3(d, e.width, e.height);
+			break;
+		default:
+			t.data.assign(d, d + (size_t)e.width * e.height * texelSize(f));
+	}
+	return t;
+}
+
+void UISoftwareRenderer::drawQuad(const UIPushConstantData& pc, const UIChromeData& chrome, VkImage img) {
+	auto t = textures.find(img);
+	const Texture* tex = t == textures.end() ? nullptr : &t->second;
+	const VkExtent2D region = UIImage::getTexRegion(pc);
+	const bool shouldblend = pc.flags & UI_PC_FLAG_BLEND;
+	const bool haschrome = chrome.cornerradius > 0 || chrome.borderwidth > 0 || chrome.shadowcolor.a > 0;
+	// UIVertex.glsl grows the quad to fit the shadow
+	UICoord margin(0, 0);
+	if (chrome.shadowcolor.a > 0) {
+		margin = UICoord(chrome.shadowblur + fabsf(chrome.shadowoffset.x), chrome.shadowblur + fabsf(chrome.shadowoffset.y));
+	}
+	const UICoord lo = pc.position - margin, hi = pc.position + pc.extent + margin;
+	const UICoord halfext = pc.extent * 0.5f;
+	const float r = std::min(chrome.cornerradius, std::min(halfext.x, halfext.y)),
+		blur = std::max(chrome.shadowblur, 0.5f);
+	// pixel centers covered by the quad, in UI coords (bottom-left origin)
+	const int32_t x0 = std::max(0.f, ceilf(lo.x - 0.5f)),
+		x1 = std::min((float)extent.width, ceilf(hi.x - 0.5f)),
+		y0 = std::max(0.f, ceilf(lo.y - 0.5f)),
+		y1 = std::min((float)extent.height, ceilf(hi.y - 0.5f));
+	UIColor texel, out, shadow;
+	UICoord local;
+	float d, a, s;
+	for (int32_t y = y0; y < y1; y++) {
+		local.y = (float)y + 0.5f - pc.position.y;
+		// framebuffer rows run top-down
+		size_t row = (size_t)(extent.height - 1 - y) * extent.width;
+		for (int32_t x = x0; x < x1; x++) {
+			local.x = (float)x + 0.5f - pc.position.x;
+			if (shouldblend) {
+				texel = sample(tex, region, local.x / pc.extent.x, local.y / pc.extent.y);
+				out = {
+					pc.bgcolor.r + (1.f - pc.bgcolor.r) * texel.r,
+					pc.bgcolor.g + (1.f - pc.bgcolor.g) * texel.r,
+					pc.bgcolor.b + (1.f - pc.bgcolor.b) * texel.r,
+					pc.bgcolor.a + (1.f - pc.bgcolor.a) * texel.r
+				};
+			}
+			else if (haschrome) out = pc.bgcolor;
+			else out = sample(tex, region, local.x / pc.extent.x, local.y / pc.extent.y);
+			if (haschrome) {
+				d = roundedBoxSDF(local - halfext, halfext, r);
+				if (chrome.borderwidth > 0) {
+					s = std::clamp(d + chrome.borderwidth + 0.5f, 0.f, 1.f);
+					out = {
+						out.r + (chrome.bordercolor.r - out.r) * s,
+						out.g + (chrome.bordercolor.g - out.g) * s,
+						out.b + (chrome.bordercolor.b - out.b) * s,
+						out.a + (chrome.bordercolor.a - out.a) * s
+					};
+				}
+				out.a *= std::clamp(0.5f - d, 0.f, 1.f);
+				shadow = {0, 0, 0, 0};
+				if (chrome.shadowcolor.a > 0) {
+					s = std::clamp((roundedBoxSDF(local - halfext - chrome.shadowoffset, halfext, r) + blur) / (2.f * blur), 0.f, 1.f);
+					shadow = chrome.shadowcolor;
+					shadow.a *= 1.f - s * s * (3.f - 2.f * s);
+				}
+				a = out.a + shadow.a * (1.f - out.a);
+				if (a > 0) {
+					out = {
+						(out.r * out.a + shadow.r * shadow.a * (1.f - out.a)) / a,
+						(out.g * out.a + shadow.g * shadow.a * (1.f - out.a)) / a,
+						(out.b * out.a + shadow.b * shadow.a * (1.f - out.a)) / a,
+						a
+					};
+				}
+				else out = {0, 0, 0, 0};
+			}
+			blend((row + x) * 4, out);
+		}
+	}
+}
+
+UIColor UISoftwareRenderer::sample(const Texture* t, VkExtent2D region, float u, float v) const {
+	if (!t || t->extent.width == 0 || t->extent.height == 0) return {0, 0, 0, 0};
+	if (region.width == 0) region = t->extent;
+	const uint32_t tx = std::min((uint32_t)std::max(0.f, u * region.width), t->extent.width - 1),
+		ty = std::min((uint32_t)std::max(0.f, v * region.height), t->extent.height - 1);
+	const unorm* texel = &t->data[((size_t)ty * t->extent.width + tx) * texelSize(t->format)];
+	if (t->format == VK_FORMAT_R8_UNORM) return {texel[0] / 255.f, 0, 0, 1};
+	return {texel[0] / 255.f, texel[1] / 255.f, texel[2] / 255.f, texel[3] / 255.f};
+}
+
+float UISoftwareRenderer::roundedBoxSDF(UICoord p, UICoord b, float r) {
+	const UICoord q = UICoord(fabsf(p.x), fabsf(p.y)) - b + UICoord(r);
+	return hypotf(std::max(q.x, 0.f), std::max(q.y, 0.f)) + std::min(std::max(q.x, q.y), 0.f) - r;
+}
+
+void UISoftwareRenderer::blend(size_t idx, UIColor c) {
+	const float a = std::clamp(c.a, 0.f, 1.f);
+	unorm* dst = &pixels[idx];
+	dst[0] = (unorm)(std::clamp(c.r, 0.f, 1.f) * 255.f * a + dst[0] * (1.f - a) + 0.5f);
+	dst[1] = (unorm)(std::clamp(c.g, 0.f, 1.f) * 255.f * a + dst[1] * (1.f - a) + 0.5f);
+	dst[2] = (unorm)(std::clamp(c.b, 0.f, 1.f) * 255.f * a + dst[2] * (1.f - a) + 0.5f);
+	dst[3] = (unorm)(255.f * a + dst[3] * (1.f - a) + 0.5f);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "UI.h"
+
+/*
+ * CPU stand-in for the Vulkan side of a host, for benchmarking and golden-image tests without a GPU.
+ * Hook it up with
+ * 	UIComponent::setDefaultDrawFunc(r.getDrawFunc());
+ * 	UIImage::setTexLoadFunc(r.getTexLoadFunc());
+ * 	UIImage::setTexDestroyFunc(r.getTexDestroyFunc());
+ * 	UIImage::setTexUpdateFunc(r.getTexUpdateFunc()); // optional
+ * after which draw() on a top-most UIComponent rasterizes into r's framebuffer (the command buffer is
+ * ignored, so VK_NULL_HANDLE is fine). Each component is a single quad computed as in UIVertex.glsl and
+ * shaded as in UIFragment.glsl, with nearest sampling and "over" alpha blending. Like the shaders, it
+ * assumes the screen extent (UIComponent::setScreenExtent) is the framebuffer's extent.
+ */
+class UISoftwareRenderer {
+public:
+	UISoftwareRenderer(VkExtent2D e);
+
+	dfType getDrawFunc();
+	tfType getTexLoadFunc();
+	tdfType getTexDestroyFunc();
+	tufType getTexUpdateFunc();
+
+	void clear(UIColor c);
+	// clears and draws each root in order
+	void render(const std::vector<const UIComponent*>& roots, UIColor c);
+	// clears and draws items in the order given, e.g. UIDrawList::getItems()
+	void renderDrawData(const std::vector<UIDrawData>& items, UIColor c);
+	// for components with no texture of their own, as with UIComponent::setNoTex
+	void setNoTex(const unorm* data, VkExtent2D e, VkFormat f);
+	VkExtent2D getExtent() const {return extent;}
+	// RGBA, top row first
+	const std::vector<unorm>& getPixels() const {return pixels;}
+	// number of pixels with any channel more than tolerance away from golden's
+	size_t diff(const std::vector<unorm>& golden, unorm tolerance) const;
+	// binary PAM (P7 RGB_ALPHA), which most image viewers and converters can read
+	bool writePAM(const char* path) const;
+	static std::vector<unorm> readPAM(const char* path, VkExtent2D& e);
+
+private:
+	typedef struct Texture {
+		VkExtent2D extent;
+		VkFormat format;
+		std::vector<unorm> data;
+	} Texture;
+
+	VkExtent2D extent;
+	std::vector<unorm> pixels;
+	std::unordered_map<VkImage, Texture> textures;
+	uint64_t nexthandle;
+
+	// block formats are kept decoded, as a GPU would sample them
+	static Texture decode(const unorm* d, VkFormat f, VkExtent2D e);
+	void drawQuad(const UIPushConstantData& pc, const UIChromeData& chrome, VkImage img);
+	static float roundedBoxSDF(UICoord p, UICoord b, float r);
+	// u and v span the region of t in use, as in UIImage::getTexRegion
+	UIColor sample(const Texture* t, VkExtent2D region, float u, float v) const;
+	void blend(size_t idx, UIColor c);
+	static size_t texelSize(VkFormat f) {return f == VK_FORMAT_R8_UNORM ? 1 : 4;}
+};
@@ -0,0 +1,122 @@
+#include "UITest.h"
+
+// a container damages all of its content when it moves or scrolls, without rescanning its subtree
+
+static bool covers(const std::vector<UIRect>& damage, UIRect r) {
+	for (const UIRect& d : damage) if (d.contains(r)) return true;
+	return false;
+}
+
+// counts how often content bounds are recomputed over it
+static uint32_t scans = 0;
+
+class UICountedComponent : public UIComponent {
+public:
+	UICountedComponent(UICoord p, UICoord e) : UIComponent(p, e) {}
+	std::vector<const UIComponent*> getChildren() const {
+		scans++;
+		return {};
+	}
+};
+
+int main() {
+	UIComponent::setScreenExtent({400, 300});
+	UIComponent::takeDamage();
+
+	{
+		UIContainer outer;
+		outer.setPos({10, 10});
+		outer.setExt({300, 200});
+		UIContainer* inner = outer.addChild(UIContainer());
+		inner->setPos({20, 20});
+		inner->setExt({50, 50});
+		UIComponent* leaf = inner->addChild(UIComponent({0, 0}, {10, 10}));
+		UIComponent::takeDamage();
+
+		// content that's moved outside its container is still damaged when an ancestor scrolls
+		leaf->setPos({200, 100});
+		UIComponent::takeDamage();
+		outer.setScroll({0, 5});
+		std::vector<UIRect> damage = UIComponent::takeDamage();
+		CHECK(covers(damage, {{230, 130}, {10, 10}}));
+		CHECK(covers(damage, {{230, 125}, {10, 10}}));
+
+		// and when the nested container moves, the outer one covers where its content went
+		inner->setPos({60, 20});
+		UIComponent::takeDamage();
+		outer.setScroll({0, 0});
+		damage = UIComponent::takeDamage();
+		CHECK(covers(damage, {{270, 125}, {10, 10}}));
+		CHECK(covers(damage, {{270, 130}, {10, 10}}));
+
+		// as does a leaf added after the bounds were computed
+		UIComponent* late = inner->addChild(UIComponent({-50, -20}, {5, 5}));
+		UIComponent::takeDamage();
+		outer.setScroll({5, 0});
+		damage = UIComponent::takeDamage();
+		CHECK(covers(damage, {{40, 10}, {5, 5}}));
+		CHECK(covers(damage, {{35, 10}, {5, 5}}));
+		late->hide();
+	}
+	UIComponent::takeDamage();
+
+	// moving one child and scrolling doesn't revisit the others
+	UIContainer box;
+	box.setExt({400, 300});
+	std::vector<UIComponent*> leaves;
+	for (uint32_t i = 0; i < 1000; i++) {
+		leaves.push_back(box.addChild(UICountedComponent({float(i % 40 * 10), float(i / 40 * 10)}, {8, 8})));
+	}
+	box.setScroll({0, 1});
+	const uint32_t first = scans;
+	CHECK(first == 1000);
+	for (uint32_t i = 0; i < 100; i++) {
+		leaves[i]->setPos({float(i), 250});
+		box.setScroll({0, float(i % 2)});
+	}
+	CHECK(scans == first);
+	// but the moved ones are still covered
+	UIComponent::takeDamage();
+	box.setScroll({0, 5});
+	CHECK(covers(UIComponent::takeDamage(), {{99, 245}, {8, 8}}));
+
+	// drawFuncs see absolute positions through getPCData, without the component's own position changing
+	{
+		UIContainer panel;
+		panel.setPos({30, 40});
+		UIComponent* child = panel.addChild(UIComponent({5, 6}, {10, 10}));
+		std::vector<UICoord> drawn;
+		UIComponent::setDefaultDrawFunc([&drawn] (const UIComponent* c, const VkCommandBuffer&) {
+			drawn.push_back(c->getPCData().position);
+		});
+		panel.draw(VK_NULL_HANDLE);
+		CHECK(drawn.size() == 2);
+		if (drawn.size() == 2) CHECK(drawn[1] == UICoord(35, 46));
+		CHECK(child->getPos() == UICoord(5, 6));
+		CHECK(child->getPCData().position == UICoord(5, 6));
+
+		// even when one throws
+		UIComponent::setDefaultDrawFunc([] (const UIComponent* c, const VkCommandBuffer&) {
+			if (c->getPCData().position == UICoord(35, 46)) throw 1;
+		});
+		bool threw = false;
+		try {panel.draw(VK_NULL_HANDLE);}
+		catch (int) {threw = true;}
+		CHECK(threw);
+		CHECK(child->getPCData().position == UICoord(5, 6));
+
+		// copies own their own children, in the copy's frame
+		panel.setPos({0, 0});
+		UIContainer copy = panel;
+		copy.setPos({100, 100});
+		CHECK(copy.getChildren().size() == 1);
+		if (copy.getChildren().size() == 1) {
+			CHECK(copy.getChildren()[0] != child);
+			CHECK(copy.getChildren()[0]->getAbsPos() == UICoord(105, 106));
+		}
+		CHECK(child->getAbsPos() == UICoord(5, 6));
+		UIComponent::setDefaultDrawFunc([] (const UIComponent*, const VkCommandBuffer&) {});
+	}
+
+	return UI_TEST_RESULT;
+}
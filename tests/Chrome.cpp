@@ -0,0 +1,64 @@
+#include "UITest.h"
+
+// rounded corners, borders and shadows are drawn analytically, like the fragment shader
+
+static const unorm* pixel(const UISoftwareRenderer& r, uint32_t x, uint32_t y) {
+	return &r.getPixels()[((size_t)(r.getExtent().height - 1 - y) * r.getExtent().width + x) * 4];
+}
+
+static bool isColor(const unorm* p, unorm r, unorm g, unorm b) {
+	return p[0] == r && p[1] == g && p[2] == b;
+}
+
+// the shadow's edge is soft, so just dark
+static bool isDark(const unorm* p) {
+	return p[0] < 32 && p[1] < 32 && p[2] < 32;
+}
+
+int main() {
+	UISoftwareRenderer r({80, 64});
+	useSoftwareRenderer(r);
+	const unorm white[4] = {255, 255, 255, 255};
+	r.setNoTex(white, {1, 1}, VK_FORMAT_R8G8B8A8_UNORM);
+
+	UIComponent c({20, 20}, {40, 20});
+	c.setBGCol({1, 0, 0, 1});
+	c.setCornerRadius(8);
+	c.setBorder(2, {0, 1, 0, 1});
+	c.setShadow({4, -4}, 2, {0, 0, 0, 1});
+	r.render({&c}, {0, 0, 1, 1});
+
+	// fill inside the border, border along the edges, background past the rounded corners
+	CHECK(isColor(pixel(r, 40, 30), 255, 0, 0));
+	CHECK(isColor(pixel(r, 40, 39), 0, 255, 0));
+	CHECK(isColor(pixel(r, 20, 30), 0, 255, 0));
+	CHECK(isColor(pixel(r, 20, 39), 0, 0, 255));
+	// the shadow is offset down and right, beyond the quad
+	CHECK(isDark(pixel(r, 50, 17)));
+	CHECK(isDark(pixel(r, 60, 25)));
+	CHECK(isColor(pixel(r, 40, 42), 0, 0, 255));
+	CHECK(isColor(pixel(r, 18, 30), 0, 0, 255));
+	// and counts towards the damage the component can cause
+	const UIRect drawn = c.getDrawRect();
+	CHECK(drawn.position.x <= 20 && drawn.position.y <= 14);
+	CHECK(drawn.position.x + drawn.extent.x >= 66 && drawn.position.y + drawn.extent.y >= 40);
+
+	// no chrome draws the quad as before
+	UIComponent plain({20, 20}, {40, 20});
+	r.render({&plain}, {0, 0, 1, 1});
+	CHECK(isColor(pixel(r, 20, 39), 255, 255, 255));
+	CHECK(isColor(pixel(r, 50, 17), 0, 0, 255));
+
+	// only UI_PC_FLAG_BLEND blends with bgcolor, other flags (e.g., a texture region) don't
+	const unorm black[4] = {0, 0, 0, 255};
+	r.setNoTex(black, {1, 1}, VK_FORMAT_R8G8B8A8_UNORM);
+	plain.setBGCol({0, 1, 0, 1});
+	plain.getPCDataPtr()->flags |= 1 << UI_PC_TEX_REGION_SHIFT | 1 << (UI_PC_TEX_REGION_SHIFT + UI_PC_TEX_REGION_BITS);
+	r.render({&plain}, {0, 0, 1, 1});
+	CHECK(isColor(pixel(r, 40, 30), 0, 0, 0));
+	plain.getPCDataPtr()->flags |= UI_PC_FLAG_BLEND;
+	r.render({&plain}, {0, 0, 1, 1});
+	CHECK(isColor(pixel(r, 40, 30), 0, 255, 0));
+
+	return UI_TEST_RESULT;
+}
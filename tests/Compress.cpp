@@ -0,0 +1,80 @@
+#include "UITest.h"
+#include "UICompress.h"
+
+// textures can be block-compressed before upload, drawing nearly as they would uncompressed
+
+static uint32_t maxError(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b) {
+	uint32_t result = 0;
+	for (size_t i = 0; i < a.size(); i++) result = std::max<uint32_t>(result, abs((int)a[i] - (int)b[i]));
+	return result;
+}
+
+int main() {
+	// BC4 keeps exact 0 and 255, which most glyph texels are, and stays close on gradients
+	std::vector<unsigned char> r8(10 * 6);
+	for (uint32_t i = 0; i < r8.size(); i++) r8[i] = i % 3 == 0 ? 0 : i % 3 == 1 ? 255 : (unsigned char)(i * 4);
+	std::vector<unsigned char> bc = UIEncodeBC4(r8.data(), 10, 6);
+	CHECK(bc.size() == 3 * 2 * 8);
+	std::vector<unsigned char> back = UIDecodeBC4(bc.data(), 10, 6);
+	CHECK(back.size() == r8.size());
+	for (size_t i = 0; i < r8.size(); i++) if (r8[i] == 0 || r8[i] == 255) CHECK(back[i] == r8[i]);
+	CHECK(maxError(r8, back) <= 40);
+
+	// BC1 reproduces flat opaque color to within its 5:6:5 endpoints, BC3 keeps alpha too
+	std::vector<unsigned char> rgba(5 * 7 * 4);
+	for (size_t i = 0; i < rgba.size(); i += 4) {
+		rgba[i] = 200;
+		rgba[i + 1] = 100;
+		rgba[i + 2] = 50;
+		rgba[i + 3] = i / 4 % 2 ? 255 : 0;
+	}
+	bc = UIEncodeBC1(rgba.data(), 5, 7);
+	CHECK(bc.size() == 2 * 2 * 8);
+	back = UIDecodeBC1(bc.data(), 5, 7);
+	for (size_t i = 0; i < back.size(); i += 4) {
+		CHECK(abs(back[i] - 200) <= 4 && abs(back[i + 1] - 100) <= 2 && abs(back[i + 2] - 50) <= 4);
+		CHECK(back[i + 3] == 255);
+	}
+	bc = UIEncodeBC3(rgba.data(), 5, 7);
+	CHECK(bc.size() == 2 * 2 * 16);
+	back = UIDecodeBC3(bc.data(), 5, 7);
+	for (size_t i = 0; i < back.size(); i += 4) CHECK(back[i + 3] == rgba[i + 3]);
+
+	// text drawn from a BC4 texture matches text drawn from R8, give or take edge blurring
+	UISoftwareRenderer r({256, 64});
+	useSoftwareRenderer(r);
+	const std::wstring s = L"Block compressed text, 0123456789";
+	std::vector<unorm> golden;
+	{
+		UIText t(s);
+		r.render({&t}, {0, 0, 0, 1});
+		CHECK(t.getTexInfo()->format == VK_FORMAT_R8_UNORM);
+		golden = r.getPixels();
+	}
+	UIImage::setTexCompression(UI_TEX_COMPRESS_TEXT, 0);
+	const UITexCompressStats before = UIImage::getTexCompressStats();
+	{
+		UIText t(s);
+		r.render({&t}, {0, 0, 0, 1});
+		CHECK(t.getTexInfo()->format == VK_FORMAT_BC4_UNORM_BLOCK);
+		const UITexCompressStats after = UIImage::getTexCompressStats();
+		CHECK(after.textures == before.textures + 1);
+		// half the size, less what the texture is padded by to fit whole blocks
+		const VkDeviceSize raw = after.rawbytes - before.rawbytes, compressed = after.compressedbytes - before.compressedbytes;
+		CHECK(compressed < raw && compressed * 2 >= raw);
+		CHECK(compressed == UIImage::texBytes(*t.getTexInfo()));
+		CHECK(r.diff(golden, 0) > 0);
+		CHECK(r.diff(golden, 16) == 0);
+	}
+
+	// textures under the threshold stay uncompressed
+	UIImage::setTexCompression(UI_TEX_COMPRESS_TEXT, 1 << 20);
+	{
+		UIText t(L"small");
+		r.render({&t}, {0, 0, 0, 1});
+		CHECK(t.getTexInfo()->format == VK_FORMAT_R8_UNORM);
+	}
+	UIImage::setTexCompression(UI_TEX_COMPRESS_NONE);
+
+	return UI_TEST_RESULT;
+}
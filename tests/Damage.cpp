@@ -0,0 +1,71 @@
+#include "UITest.h"
+
+// changes to shown components damage the screen regions they covered and now cover
+
+static bool covers(const std::vector<UIRect>& damage, UIRect r) {
+	for (const UIRect& d : damage) {
+		if (d.position.x <= r.position.x && d.position.y <= r.position.y
+			&& d.position.x + d.extent.x >= r.position.x + r.extent.x
+			&& d.position.y + d.extent.y >= r.position.y + r.extent.y) {
+			return true;
+		}
+	}
+	return false;
+}
+
+int main() {
+	UIComponent::setScreenExtent({200, 100});
+	// the first frame is all damage
+	CHECK(covers(UIComponent::takeDamage(), {{0, 0}, {200, 100}}));
+	CHECK(UIComponent::takeDamage().empty());
+
+	UIComponent* c = new UIComponent({10, 10}, {20, 20});
+	UIComponent::takeDamage();
+
+	// moving damages where it was and where it is
+	c->setPos({50, 10});
+	std::vector<UIRect> damage = UIComponent::takeDamage();
+	CHECK(covers(damage, {{10, 10}, {20, 20}}));
+	CHECK(covers(damage, {{50, 10}, {20, 20}}));
+	// unchanged, no damage
+	c->setPos({50, 10});
+	CHECK(UIComponent::takeDamage().empty());
+	// damage is clipped to the screen
+	c->setPos({190, 90});
+	for (const UIRect& d : UIComponent::takeDamage()) {
+		CHECK(d.position.x + d.extent.x <= 200 && d.position.y + d.extent.y <= 100);
+	}
+	c->setPos({50, 10});
+	UIComponent::takeDamage();
+
+	// destroying a shown component damages where it was
+	delete c;
+	CHECK(covers(UIComponent::takeDamage(), {{50, 10}, {20, 20}}));
+
+	// a hidden one was never drawn there
+	c = new UIComponent({10, 10}, {20, 20});
+	c->hide();
+	UIComponent::takeDamage();
+	delete c;
+	CHECK(UIComponent::takeDamage().empty());
+
+	// children of a container damage where they are on screen
+	{
+		UIContainer box;
+		box.setPos({100, 50});
+		box.setExt({80, 40});
+		UIComponent* child = box.addChild(UIComponent({5, 5}, {10, 10}));
+		UIComponent::takeDamage();
+		box.setScroll({0, 2});
+		CHECK(covers(UIComponent::takeDamage(), {{105, 55}, {10, 10}}));
+		child->setBGCol({1, 0, 0, 1});
+		CHECK(covers(UIComponent::takeDamage(), {{105, 53}, {10, 10}}));
+		UIComponent::takeDamage();
+	}
+	// as do they and the container when it's destroyed
+	damage = UIComponent::takeDamage();
+	CHECK(covers(damage, {{100, 50}, {80, 40}}));
+	CHECK(covers(damage, {{105, 53}, {10, 10}}));
+
+	return UI_TEST_RESULT;
+}
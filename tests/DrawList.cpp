@@ -0,0 +1,68 @@
+#include "UITest.h"
+#include <chrono>
+
+// a draw list sorted into state batches draws exactly what drawing in tree order does
+
+int main() {
+	UISoftwareRenderer r({160, 120});
+	useSoftwareRenderer(r);
+
+	// overlapping components in three states, some hanging off or entirely off the screen, and text
+	UIContainer box;
+	box.setExt({160, 120});
+	uint32_t seed = 12345;
+	auto rnd = [&seed] (uint32_t n) {
+		seed = seed * 1664525 + 1013904223;
+		return (seed >> 8) % n;
+	};
+	for (uint32_t i = 0; i < 300; i++) {
+		UIComponent* c = box.addChild(UIComponent(
+			{(float)rnd(240) - 40, (float)rnd(200) - 40},
+			{(float)rnd(40) + 1, (float)rnd(40) + 1}));
+		c->setBGCol({rnd(256) / 255.f, rnd(256) / 255.f, rnd(256) / 255.f, rnd(2) ? 1.f : 0.5f});
+		c->setDS((VkDescriptorSet)(uintptr_t)(rnd(3) + 1));
+	}
+	box.addChild(UIComponent({1000, 1000}, {10, 10}));
+	box.addChild(UIText(L"draw list", {20, 30}));
+	box.addChild(UIComponent({25, 35}, {10, 10}))->setBGCol({0, 1, 0, 1});
+
+	r.render({&box}, {0, 0, 0, 1});
+	const std::vector<unorm> golden = r.getPixels();
+	UIDrawList list;
+	list.build({&box});
+	r.renderDrawData(list.getItems(), {0, 0, 0, 1});
+	CHECK(r.diff(golden, 0) == 0);
+	const UIDrawListStats& stats = list.getStats();
+	CHECK(stats.culled > 0);
+	CHECK(stats.items + stats.culled == 300 + 4);
+	CHECK(stats.batches < stats.treebatches);
+
+	// a stack of items in one state is one layer and one batch, and doesn't take quadratic time
+	std::vector<UIComponent> stack(20000, UIComponent({10, 10}, {30, 30}));
+	std::vector<const UIComponent*> stackptrs;
+	for (const UIComponent& c : stack) stackptrs.push_back(&c);
+	const auto start = std::chrono::steady_clock::now();
+	list.build(stackptrs);
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	CHECK(list.getStats().layers == 1 && list.getStats().batches == 1);
+	CHECK(ms < 1000);
+	// but a different state at the top of the stack still separates what's above it
+	stack[10000].setDS((VkDescriptorSet)1);
+	list.build(stackptrs);
+	CHECK(list.getStats().layers == 3 && list.getStats().batches == 3);
+
+	// with no screen extent nothing is clipped, and items far apart don't make a huge grid
+	UIComponent::setScreenExtent({0, 0});
+	UIComponent nearby({0, 0}, {10, 10}), far({1e7, 1e7}, {10, 10}), farther({-1e9, 3e8}, {5, 5});
+	list.build({&nearby, &far, &farther});
+	CHECK(list.getStats().items == 3 && list.getStats().culled == 0);
+	CHECK(list.getStats().layers == 1);
+	// overlap is still found at that scale
+	UIComponent over({1e7 + 5, 1e7 + 5}, {10, 10});
+	over.setDS((VkDescriptorSet)2);
+	list.build({&nearby, &far, &farther, &over});
+	CHECK(list.getStats().layers == 2);
+	CHECK(list.getItems().back().source == &over);
+
+	return UI_TEST_RESULT;
+}
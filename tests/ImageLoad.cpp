@@ -0,0 +1,198 @@
+#include "UITest.h"
+#include "UIPNG.h"
+#include <cstring>
+#include <stdexcept>
+
+// images decode on worker threads into a bounded cache, and hostile files fail cleanly
+
+static void put32(std::vector<unorm>& out, uint32_t x) {
+	for (int s = 24; s >= 0; s -= 8) out.push_back((unorm)(x >> s));
+}
+
+static void chunk(std::vector<unorm>& png, const char* type, const std::vector<unorm>& data) {
+	put32(png, data.size());
+	png.insert(png.end(), type, type + 4);
+	png.insert(png.end(), data.begin(), data.end());
+	uint32_t crc = 0xffffffff;
+	for (size_t i = png.size() - data.size() - 4; i < png.size(); i++) {
+		crc ^= png[i];
+		for (int k = 0; k < 8; k++) crc = crc & 1 ? 0xedb88320 ^ (crc >> 1) : crc >> 1;
+	}
+	put32(png, ~crc);
+}
+
+// RGBA PNG with the given zlib stream as its image data
+static std::vector<unorm> makePNG(uint32_t w, uint32_t h, const std::vector<unorm>& zlib) {
+	std::vector<unorm> png = {137, 80, 78, 71, 13, 10, 26, 10}, ihdr;
+	put32(ihdr, w);
+	put32(ihdr, h);
+	ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0});
+	chunk(png, "IHDR", ihdr);
+	chunk(png, "IDAT", zlib);
+	chunk(png, "IEND", {});
+	return png;
+}
+
+// zlib stream of raw in stored blocks, adler32 left as 0 since it isn't checked
+static std::vector<unorm> stored(const std::vector<unorm>& raw) {
+	std::vector<unorm> z = {0x78, 0x01};
+	for (size_t pos = 0; pos == 0 || pos < raw.size(); pos += 65535) {
+		const uint16_t len = (uint16_t)std::min<size_t>(65535, raw.size() - pos);
+		z.push_back(pos + len >= raw.size() ? 1 : 0);
+		z.insert(z.end(), {(unorm)len, (unorm)(len >> 8), (unorm)~len, (unorm)(~len >> 8)});
+		z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+	}
+	z.insert(z.end(), {0, 0, 0, 0});
+	return z;
+}
+
+// a fixed Huffman block of one 0 then repeats copies of the last 258 bytes, about 160x bigger inflated
+static std::vector<unorm> bomb(size_t repeats) {
+	std::vector<unorm> z = {0x78, 0x01};
+	uint32_t buf = 0, n = 0;
+	auto bits = [&] (uint32_t v, uint32_t count) {
+		buf |= v << n;
+		n += count;
+		while (n >= 8) {
+			z.push_back((unorm)buf);
+			buf >>= 8;
+			n -= 8;
+		}
+	};
+	// Huffman codes go in most significant bit first
+	auto code = [&] (uint32_t c, uint32_t len) {
+		for (int i = len - 1; i >= 0; i--) bits(c >> i & 1, 1);
+	};
+	bits(1, 1);
+	bits(1, 2);
+	code(0x30, 8);
+	for (size_t i = 0; i < repeats; i++) {
+		code(0xc5, 8); // length 258
+		code(0, 5); // distance 1
+	}
+	code(0, 7); // end of block
+	bits(0, 7);
+	z.insert(z.end(), {0, 0, 0, 0});
+	return z;
+}
+
+static bool writeFile(const char* path, const std::vector<unorm>& bytes) {
+	FILE* f = fopen(path, "wb");
+	if (!f) return false;
+	const bool result = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+	fclose(f);
+	return result;
+}
+
+static void waitForLoads() {
+	while (UIImage::getLoadStats().queued) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	UIImage::uploadLoaded();
+}
+
+int main() {
+	UISoftwareRenderer r({64, 64});
+	useSoftwareRenderer(r);
+	std::vector<unorm> rgba;
+	uint32_t w, h;
+
+	// a 2x2 image, each row with a filter byte
+	const std::vector<unorm> raw = {
+		0, 255, 0, 0, 255, 0, 255, 0, 255,
+		0, 0, 0, 255, 255, 255, 255, 255, 128
+	};
+	const std::vector<unorm> good = makePNG(2, 2, stored(raw));
+	CHECK(UIDecodePNG(good.data(), good.size(), rgba, w, h));
+	CHECK(w == 2 && h == 2);
+	CHECK(rgba == std::vector<unorm>({255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255, 255, 255, 255, 128}));
+
+	// the header alone can't make the decoder allocate: 2^24 x 2^24 in 53 bytes
+	std::vector<unorm> huge = makePNG(1 << 24, 1 << 24, {});
+	CHECK(huge.size() < 64);
+	CHECK(!UIDecodePNG(huge.data(), huge.size(), rgba, w, h));
+	// nor can a size under the cap with next to no data
+	huge = makePNG(8192, 8192, stored({0}));
+	CHECK(!UIDecodePNG(huge.data(), huge.size(), rgba, w, h));
+
+	// inflating stops once there's more than the image needs, however much more the stream has
+	const std::vector<unorm> fits = makePNG(6450, 1, bomb(100));
+	CHECK(UIDecodePNG(fits.data(), fits.size(), rgba, w, h));
+	std::vector<unorm> bombed = makePNG(2, 2, bomb(1));
+	CHECK(!UIDecodePNG(bombed.data(), bombed.size(), rgba, w, h));
+	bombed = makePNG(1000, 1000, bomb(1 << 20));
+	CHECK(bombed.size() < (2 << 20));
+	const auto start = std::chrono::steady_clock::now();
+	CHECK(!UIDecodePNG(bombed.data(), bombed.size(), rgba, w, h));
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+	// but a stream of exactly the right size is fine
+	std::vector<unorm> exact(4 * (2 * 4 + 1), 0);
+	const std::vector<unorm> exactpng = makePNG(2, 4, stored(exact));
+	CHECK(UIDecodePNG(exactpng.data(), exactpng.size(), rgba, w, h));
+
+	// through UIImage, from files
+	CHECK(writeFile("good.png", good));
+	CHECK(writeFile("huge.png", makePNG(1 << 24, 1 << 24, {})));
+	UIImage img({0, 0});
+	img.setSource("good.png");
+	img.prepareDraw();
+	waitForLoads();
+	CHECK(img.getExt() == UICoord(2, 2));
+	CHECK(img.getTex().image != UIComponent::getNoTex().image);
+	UIImage bad({0, 0});
+	bad.setSource("huge.png");
+	bad.prepareDraw();
+	waitForLoads();
+	CHECK(bad.getTex().image == UIComponent::getNoTex().image);
+	CHECK(UIImage::getLoadStats().failed == 1);
+
+	// a decoder that throws fails the load rather than the process
+	UIImage::setDecodeFunc([] (const std::string& path, std::vector<unorm>& pixels, VkExtent2D& e) -> bool {
+		if (path == "throws") throw std::bad_alloc();
+		e = {64, 64};
+		pixels.assign(64 * 64 * 4, (unorm)path.size());
+		return true;
+	});
+	UIImage thrower({0, 0});
+	thrower.setSource("throws");
+	thrower.prepareDraw();
+	waitForLoads();
+	CHECK(UIImage::getLoadStats().failed == 2);
+	CHECK(thrower.getTex().image == UIComponent::getNoTex().image);
+
+	// the cache keeps to its limit, least recently used first
+	UIImage::clearDecodeCache();
+	UIImage::setDecodeCacheLimit(3 * 64 * 64 * 4);
+	std::vector<UIImage> many(8, UIImage({0, 0}));
+	for (size_t i = 0; i < many.size(); i++) {
+		many[i].setSource("image" + std::to_string(i));
+		many[i].prepareDraw();
+		waitForLoads();
+		CHECK(UIImage::getLoadStats().cachebytes <= 3 * 64 * 64 * 4);
+	}
+	for (const UIImage& i : many) CHECK(i.getTex().image != UIComponent::getNoTex().image);
+	CHECK(UIImage::getLoadStats().cacheevictions >= 5);
+	// the newest is always kept, however big
+	UIImage::setDecodeCacheLimit(1);
+	CHECK(UIImage::getLoadStats().cachebytes > 64 * 64 * 4);
+
+	// decodes waiting to be uploaded aren't evicted, even when uploads are spread over frames
+	UIImage::clearDecodeCache();
+	const uint64_t decoded = UIImage::getLoadStats().decoded;
+	std::vector<UIImage> batch(6, UIImage({0, 0}));
+	for (size_t i = 0; i < batch.size(); i++) {
+		batch[i].setSource("batch" + std::to_string(i));
+		batch[i].prepareDraw();
+	}
+	while (UIImage::getLoadStats().queued) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	for (size_t frame = 0; frame < batch.size() * 2; frame++) {
+		UIImage::uploadLoaded(1);
+		for (UIImage& i : batch) i.prepareDraw();
+		while (UIImage::getLoadStats().queued) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	for (const UIImage& i : batch) CHECK(i.getTex().image != UIComponent::getNoTex().image);
+	CHECK(UIImage::getLoadStats().decoded == decoded + batch.size());
+	// and once they are, the cache goes back to its limit
+	CHECK(UIImage::getLoadStats().cachebytes < 2 * 64 * 64 * 4);
+	UIImage::setDecodeCacheLimit(UI_DEFAULT_DECODE_CACHE_LIMIT);
+
+	return UI_TEST_RESULT;
+}
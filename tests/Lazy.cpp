@@ -0,0 +1,40 @@
+#include "UITest.h"
+
+// UIText rasterizes only once it's drawn while shown, and only its latest text
+
+int main() {
+	UISoftwareRenderer r({200, 100});
+	useSoftwareRenderer(r);
+	const uint64_t loads = UIImage::getTexStats().loads;
+
+	UIText t(L"first");
+	t.hide();
+	for (int i = 0; i < 100; i++) t.setText(L"text " + std::to_wstring(i));
+	CHECK(UIImage::getTexStats().loads == loads);
+	// the extent is known without a texture
+	CHECK(t.getExt().x > 0 && t.getExt().y > 0);
+
+	// hidden components aren't drawn, so still nothing to generate
+	r.render({&t}, {0, 0, 0, 1});
+	CHECK(UIImage::getTexStats().loads == loads);
+	CHECK(t.getTex().image == VK_NULL_HANDLE);
+
+	t.show();
+	CHECK(UIImage::getTexStats().loads == loads);
+	r.render({&t}, {0, 0, 0, 1});
+	CHECK(UIImage::getTexStats().loads == loads + 1);
+	CHECK(t.getTex().image != VK_NULL_HANDLE);
+
+	// drawing the same text again doesn't regenerate it
+	r.render({&t}, {0, 0, 0, 1});
+	CHECK(UIImage::getTexStats().loads == loads + 1);
+
+	// a lazily generated texture looks the same as one generated right away
+	std::vector<unorm> lazy = r.getPixels();
+	UIText eager(L"text 99");
+	eager.prepareDraw();
+	r.render({&eager}, {0, 0, 0, 1});
+	CHECK(r.diff(lazy, 0) == 0);
+
+	return UI_TEST_RESULT;
+}
@@ -0,0 +1,53 @@
+#include "UITest.h"
+#include "VulkanStub.h"
+#include <set>
+#include <mutex>
+
+// drawParallel records each root into its own secondary and executes them in order
+
+int main() {
+	std::mutex m;
+	std::map<VkCommandBuffer, std::vector<const UIComponent*>> recorded;
+	std::set<std::thread::id> threads;
+	UIComponent::setDefaultDrawFunc([&] (const UIComponent* c, const VkCommandBuffer& cb) {
+		std::lock_guard<std::mutex> lock(m);
+		recorded[cb].push_back(c);
+		threads.insert(std::this_thread::get_id());
+	});
+
+	std::vector<UIComponent> roots(8, UIComponent({0, 0}, {10, 10}));
+	std::vector<const UIComponent*> rootptrs;
+	std::vector<VkCommandBuffer> secondaries;
+	for (size_t i = 0; i < roots.size(); i++) {
+		roots[i].setPos({(float)i * 20, 0});
+		rootptrs.push_back(&roots[i]);
+		secondaries.push_back((VkCommandBuffer)(i + 1));
+	}
+	const VkCommandBufferInheritanceInfo inheritance = {};
+	VulkanStubLog& log = vulkanStubLog();
+
+	for (uint32_t frame = 0; frame < 100; frame++) {
+		recorded.clear();
+		log.executed.clear();
+		CHECK(UIComponent::drawParallel(rootptrs, secondaries, inheritance, VK_NULL_HANDLE));
+		CHECK(log.executed == secondaries);
+		for (size_t i = 0; i < roots.size(); i++) {
+			CHECK(recorded[secondaries[i]].size() == 1 && recorded[secondaries[i]][0] == &roots[i]);
+		}
+	}
+	CHECK(log.executecalls == 100);
+	// the pool is kept, so there are never more recording threads than cores (or roots)
+	CHECK(threads.size() <= std::max(std::thread::hardware_concurrency(), 2u));
+
+	// nothing to execute, so no vkCmdExecuteCommands with a count of 0
+	const size_t begun = log.begun.size();
+	CHECK(UIComponent::drawParallel({}, {}, inheritance, VK_NULL_HANDLE));
+	CHECK(log.executecalls == 100);
+
+	// too few secondaries is an error, and nothing is recorded
+	CHECK(!UIComponent::drawParallel(rootptrs, {secondaries[0]}, inheritance, VK_NULL_HANDLE));
+	CHECK(log.begun.size() == begun);
+	CHECK(log.executecalls == 100);
+
+	return UI_TEST_RESULT;
+}
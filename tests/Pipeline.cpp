@@ -0,0 +1,65 @@
+#include "UITest.h"
+#include "VulkanStub.h"
+#include "UIPipeline.h"
+#include <filesystem>
+
+// UIPipelineBuilder bakes the screen extent into its pipelines and persists its pipeline cache
+
+int main() {
+	VulkanStubLog& log = vulkanStubLog();
+	const std::string cachepath = "pipeline.cache";
+	std::filesystem::remove(cachepath);
+	CHECK(UIPipelineBuilder::hasEmbeddedShaders());
+
+	{
+		UIPipelineBuilder builder(VK_NULL_HANDLE, VK_NULL_HANDLE, cachepath);
+		CHECK(!builder.getStats().cacheloaded);
+
+		// with no screen extent yet, the vertex shader would divide by 0
+		UIComponent::setScreenExtent({0, 0});
+		UIPipelineInfo p = builder.build(VK_NULL_HANDLE, 0, VK_SAMPLE_COUNT_1_BIT);
+		CHECK(p.pipeline == VK_NULL_HANDLE);
+		CHECK(log.pipelines == 0);
+		UIComponent::setScreenExtent({800, 0});
+		p = builder.build(VK_NULL_HANDLE, 0, VK_SAMPLE_COUNT_1_BIT);
+		CHECK(p.pipeline == VK_NULL_HANDLE);
+		CHECK(log.pipelines == 0);
+
+		UIComponent::setScreenExtent({800, 600});
+		p = builder.build(VK_NULL_HANDLE, 0, VK_SAMPLE_COUNT_1_BIT);
+		CHECK(p.pipeline != VK_NULL_HANDLE && p.layout != VK_NULL_HANDLE && p.dsl != VK_NULL_HANDLE);
+		CHECK(log.pipelines == 1);
+		CHECK(log.specdata[0] == 800 && log.specdata[1] == 600);
+		CHECK(p.pushconstantrange.size == sizeof(UIPushConstantData) + sizeof(UIChromeData));
+		builder.destroy(p);
+		CHECK(p.pipeline == VK_NULL_HANDLE);
+
+		UIComponent::setScreenExtent({1024, 768});
+		p = builder.build(VK_NULL_HANDLE, 0, VK_SAMPLE_COUNT_1_BIT);
+		CHECK(log.specdata[0] == 1024 && log.specdata[1] == 768);
+		builder.destroy(p);
+	}
+
+	// saved on destruction, and loaded by the next builder on the same device
+	CHECK(std::filesystem::exists(cachepath));
+	{
+		UIPipelineBuilder builder(VK_NULL_HANDLE, VK_NULL_HANDLE, cachepath);
+		CHECK(builder.getStats().cacheloaded);
+		CHECK(builder.getStats().cachebytes > 0);
+	}
+
+	// a cache from another device or driver is ignored
+	FILE* f = fopen(cachepath.c_str(), "r+b");
+	CHECK(f);
+	if (f) {
+		fseek(f, 8, SEEK_SET);
+		fputc(0xff, f);
+		fclose(f);
+	}
+	{
+		UIPipelineBuilder builder(VK_NULL_HANDLE, VK_NULL_HANDLE, cachepath);
+		CHECK(!builder.getStats().cacheloaded);
+	}
+
+	return UI_TEST_RESULT;
+}
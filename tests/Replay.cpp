@@ -0,0 +1,67 @@
+#include "UITest.h"
+#include "UIReplay.h"
+
+// recordings round trip through files, and corrupt ones load as nothing
+
+static bool writeFile(const char* path, const std::vector<unorm>& bytes) {
+	FILE* f = fopen(path, "wb");
+	if (!f) return false;
+	const bool result = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+	fclose(f);
+	return result;
+}
+
+static std::vector<unorm> readFile(const char* path) {
+	std::vector<unorm> result;
+	FILE* f = fopen(path, "rb");
+	if (!f) return result;
+	int c;
+	while ((c = fgetc(f)) != EOF) result.push_back((unorm)c);
+	fclose(f);
+	return result;
+}
+
+int main() {
+	UIInputRecorder rec;
+	for (int i = 0; i < 100; i++) {
+		rec.recordMousePos({(float)i * 1.5f, 20.f - (float)i / 16.f});
+		if (i % 10 == 0) rec.recordMouseClick(i % 20 == 0);
+	}
+	CHECK(rec.save("replay.uiir"));
+	const std::vector<UIInputEvent> loaded = UIInputRecorder::load("replay.uiir");
+	CHECK(loaded.size() == rec.getEvents().size());
+	for (size_t i = 0; i < loaded.size() && i < rec.getEvents().size(); i++) {
+		const UIInputEvent& a = loaded[i], & b = rec.getEvents()[i];
+		CHECK(a.time == b.time && a.type == b.type && a.pos == b.pos);
+	}
+
+	const std::vector<unorm> good = readFile("replay.uiir");
+	CHECK(!good.empty());
+	// every truncation fails rather than returning some of the events
+	for (size_t n = 0; n < good.size(); n++) {
+		CHECK(writeFile("truncated.uiir", std::vector<unorm>(good.begin(), good.begin() + n)));
+		CHECK(UIInputRecorder::load("truncated.uiir").empty());
+	}
+	// so do extra bytes, as count must be wrong
+	std::vector<unorm> extra = good;
+	extra.push_back(UI_INPUT_EVENT_MOUSE_PRESS);
+	extra.push_back(0);
+	CHECK(writeFile("extra.uiir", extra));
+	CHECK(UIInputRecorder::load("extra.uiir").empty());
+
+	// a huge count in a tiny file is rejected without trying to allocate for it
+	const std::vector<unorm> huge = {'U', 'I', 'I', 'R', 1, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3f, 2, 0};
+	CHECK(writeFile("huge.uiir", huge));
+	CHECK(UIInputRecorder::load("huge.uiir").empty());
+
+	CHECK(UIInputRecorder::load("missing.uiir").empty());
+
+	// replaying delivers every event
+	UIComponent target({0, 0}, {200, 40});
+	UIComponent::resetEventStats();
+	const UIReplayStats stats = UIInputReplay::replay(loaded, {&target}, nullptr);
+	CHECK(stats.numevents == loaded.size());
+	CHECK(stats.callbacks.clickbegin > 0);
+
+	return UI_TEST_RESULT;
+}
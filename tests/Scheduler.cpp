@@ -0,0 +1,104 @@
+#include "UITest.h"
+
+// UIScheduler spreads texture generation and scheduled work over frames within a budget
+
+static bool blank(const UISoftwareRenderer& r, UIRect rect) {
+	for (uint32_t y = rect.position.y; y < rect.position.y + rect.extent.y; y++) {
+		for (uint32_t x = rect.position.x; x < rect.position.x + rect.extent.x; x++) {
+			const unorm* p = &r.getPixels()[((size_t)(r.getExtent().height - 1 - y) * r.getExtent().width + x) * 4];
+			if (p[0] || p[1] || p[2]) return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	UISoftwareRenderer r({512, 128});
+	useSoftwareRenderer(r);
+	// tiny, so only the first texture each frame is made
+	UIScheduler::setBudget(1e-9);
+
+	// texts past the first are put off to later frames, one per frame
+	std::vector<UIText*> texts;
+	for (uint32_t i = 0; i < 3; i++) texts.push_back(new UIText(L"t" + std::to_wstring(i), {(float)i * 100, 0}));
+	uint32_t frames = 0;
+	while (frames < 10) {
+		UIScheduler::beginFrame();
+		for (UIText* t : texts) t->draw(VK_NULL_HANDLE);
+		UIScheduler::endFrame();
+		frames++;
+		if (texts.back()->getTexInfo()->image) break;
+	}
+	CHECK(frames == 3);
+	CHECK(UIScheduler::getStats().deferred == 0);
+
+	// changed text isn't drawn stretched from its old texture while it waits
+	UIText first(L"first", {0, 70});
+	first.hide();
+	texts[0]->setText(L"a much longer text");
+	UIScheduler::beginFrame();
+	first.show();
+	r.render({&first, texts[0]}, {0, 0, 0, 1});
+	UIScheduler::endFrame();
+	CHECK(UIScheduler::getStats().deferred == 1);
+	CHECK(blank(r, {{0, 0}, texts[0]->getExt()}));
+	UIScheduler::beginFrame();
+	r.render({texts[0]}, {0, 0, 0, 1});
+	UIScheduler::endFrame();
+	const std::vector<unorm> drawn = r.getPixels();
+	{
+		UIScheduler::setBudget(0);
+		UIText fresh(L"a much longer text");
+		r.render({&fresh}, {0, 0, 0, 1});
+		CHECK(r.diff(drawn, 0) == 0);
+		UIScheduler::setBudget(1e-9);
+	}
+
+	// off-screen components destroyed before endFrame, by scheduled work or otherwise, are dropped
+	for (UIText* t : texts) {
+		t->setPos({1000, 0});
+		t->setText(L"off screen");
+	}
+	UIScheduler::beginFrame();
+	for (UIText* t : texts) t->draw(VK_NULL_HANDLE);
+	delete texts[0];
+	UIText* doomed = texts[1];
+	UIScheduler::schedule([doomed] () {delete doomed;});
+	UIScheduler::setBudget(1000);
+	UIScheduler::endFrame();
+	CHECK(UIScheduler::getStats().done == 2);
+	// the survivor's texture was made while it was off screen
+	CHECK(texts[2]->getTexInfo()->image != VK_NULL_HANDLE);
+	UIScheduler::setBudget(0);
+	delete texts[2];
+
+	// copies and swaps leave the off-screen list pointing at live objects
+	UIScheduler::setBudget(1e-9);
+	UIText* queued = new UIText(L"queued", {1000, 0});
+	UIText* other = new UIText(L"other", {1000, 0});
+	UIScheduler::beginFrame();
+	queued->draw(VK_NULL_HANDLE);
+	delete new UIText(*queued);
+	// queued stays listed, now holding other's text, and other isn't though it holds queued's
+	swap(*queued, *other);
+	delete other;
+	UIScheduler::setBudget(1000);
+	CHECK(UIScheduler::endFrame() == 1);
+	CHECK(queued->getTexInfo()->image != VK_NULL_HANDLE);
+	delete queued;
+
+	// scheduled work runs in order, at least one piece per frame
+	UIScheduler::setBudget(1e-9);
+	std::vector<int> ran;
+	for (int i = 0; i < 3; i++) UIScheduler::schedule([&ran, i] () {ran.push_back(i);});
+	UIScheduler::beginFrame();
+	UIScheduler::endFrame();
+	CHECK(ran == std::vector<int>({0}));
+	CHECK(UIScheduler::getStats().queued == 2);
+	UIScheduler::setBudget(0);
+	UIScheduler::beginFrame();
+	UIScheduler::endFrame();
+	CHECK(ran == std::vector<int>({0, 1, 2}));
+
+	return UI_TEST_RESULT;
+}
@@ -0,0 +1,53 @@
+#include "UITest.h"
+
+// identical text shares one texture, which outlives all but its last user
+
+int main() {
+	UISoftwareRenderer r({200, 100});
+	useSoftwareRenderer(r);
+	uint32_t destroys = 0;
+	tdfType destroy = r.getTexDestroyFunc();
+	UIImage::setTexDestroyFunc([&] (UIImage* i) {
+		destroys++;
+		destroy(i);
+	});
+	const uint64_t loads = UIImage::getTexStats().loads;
+
+	// more users than fit in a byte
+	std::vector<UIText*> texts;
+	for (int i = 0; i < 300; i++) {
+		texts.push_back(new UIText(L"OK"));
+		texts.back()->prepareDraw();
+	}
+	CHECK(UIImage::getTexStats().loads == loads + 1);
+	CHECK(UIImage::getTexStats().residenttextures == 1);
+	const VkImage img = texts[0]->getTex().image;
+	for (UIText* t : texts) CHECK(t->getTex().image == img);
+
+	for (int i = 0; i < 60; i++) {
+		delete texts.back();
+		texts.pop_back();
+	}
+	CHECK(destroys == 0);
+	UIText late(L"OK");
+	late.prepareDraw();
+	CHECK(late.getTex().image == img);
+	CHECK(UIImage::getTexStats().loads == loads + 1);
+
+	// changing one's text leaves the others with the shared texture
+	texts[0]->setText(L"NO");
+	texts[0]->prepareDraw();
+	CHECK(texts[0]->getTex().image != img);
+	CHECK(texts[1]->getTex().image == img);
+	CHECK(destroys == 0);
+
+	for (UIText* t : texts) delete t;
+	CHECK(destroys == 1);
+	late.setText(L"gone");
+	CHECK(destroys == 1);
+	late.prepareDraw();
+	CHECK(destroys == 2);
+	CHECK(UIImage::getTexStats().residenttextures == 1);
+
+	return UI_TEST_RESULT;
+}
@@ -0,0 +1,88 @@
+#include "UITest.h"
+
+// mutations queue from any thread, and snapshots stay drawable while their components change
+
+int main() {
+	UISoftwareRenderer r({200, 100});
+	useSoftwareRenderer(r);
+	UIImage::setTexUpdateFunc(r.getTexUpdateFunc());
+	uint32_t destroys = 0;
+	tdfType destroy = r.getTexDestroyFunc();
+	UIImage::setTexDestroyFunc([&] (UIImage* i) {
+		destroys++;
+		destroy(i);
+	});
+
+	// pushes from several threads are all applied, each thread's in order
+	{
+		UIMutationQueue q;
+		std::vector<int> seen;
+		std::vector<std::thread> producers;
+		for (int t = 0; t < 4; t++) {
+			producers.emplace_back([&q, &seen, t] () {
+				for (int i = 0; i < 1000; i++) q.push([&seen, t, i] () {seen.push_back(t * 1000 + i);});
+			});
+		}
+		size_t applied = 0;
+		while (applied < 4000) applied += q.apply();
+		for (std::thread& p : producers) p.join();
+		CHECK(q.apply() == 0);
+		CHECK(seen.size() == 4000);
+		std::vector<int> last(4, -1);
+		for (int v : seen) {
+			CHECK(v > last[v / 1000]);
+			last[v / 1000] = v;
+		}
+	}
+
+	UIFrameSnapshots snapshots;
+	CHECK(snapshots.acquire() == nullptr);
+	UIText* t = new UIText(L"snapshot text", {10, 10});
+	snapshots.capture({t});
+	UIFrameSnapshots::Snapshot held = snapshots.acquire();
+	CHECK(held && held->size() == 1);
+	r.renderDrawData(*held, {0, 0, 0, 1});
+	const std::vector<unorm> golden = r.getPixels();
+	const VkImage img = t->getTex().image;
+
+	// changing the text can't update the texture the held snapshot draws in place
+	const uint64_t updates = UIImage::getTexStats().updates;
+	t->setText(L"snap");
+	t->prepareDraw();
+	CHECK(UIImage::getTexStats().updates == updates);
+	CHECK(t->getTex().image != img);
+	// nor can destroying the component destroy it
+	delete t;
+	snapshots.capture({});
+	snapshots.capture({});
+	CHECK(destroys == 1);
+	r.renderDrawData(*held, {0, 0, 0, 1});
+	CHECK(r.diff(golden, 0) == 0);
+
+	// once the render thread lets go, the next capture destroys it
+	held.reset();
+	snapshots.capture({});
+	CHECK(destroys == 2);
+	CHECK(UIImage::getTexStats().residenttextures == 0);
+
+	// snapshots taken and dropped by another thread while components come and go
+	std::atomic<bool> done = false;
+	std::thread render([&snapshots, &done] () {
+		while (!done) {
+			UIFrameSnapshots::Snapshot s = snapshots.acquire();
+			if (s) for (const UIDrawData& d : *s) CHECK(d.image != VK_NULL_HANDLE);
+		}
+	});
+	for (int frame = 0; frame < 200; frame++) {
+		UIText f(L"frame " + std::to_wstring(frame));
+		f.prepareDraw();
+		snapshots.capture({&f});
+	}
+	done = true;
+	render.join();
+	snapshots.capture({});
+	snapshots.capture({});
+	CHECK(UIImage::getTexStats().residenttextures == 0);
+
+	return UI_TEST_RESULT;
+}
@@ -0,0 +1,59 @@
+#include "UITest.h"
+
+// UISoftwareRenderer draws components as the shaders would, into an RGBA framebuffer
+
+static const unorm* pixel(const UISoftwareRenderer& r, uint32_t x, uint32_t y) {
+	// UI coords are bottom-left origin, the framebuffer is top row first
+	return &r.getPixels()[((size_t)(r.getExtent().height - 1 - y) * r.getExtent().width + x) * 4];
+}
+
+int main() {
+	UISoftwareRenderer r({64, 32});
+	useSoftwareRenderer(r);
+	const unorm red[4] = {255, 0, 0, 255};
+	r.setNoTex(red, {1, 1}, VK_FORMAT_R8G8B8A8_UNORM);
+
+	// untextured components sample notex
+	UIComponent c({8, 4}, {16, 8});
+	r.render({&c}, {0, 0, 1, 1});
+	size_t reds = 0;
+	for (uint32_t y = 0; y < 32; y++) {
+		for (uint32_t x = 0; x < 64; x++) {
+			const unorm* p = pixel(r, x, y);
+			const bool inside = x >= 8 && x < 24 && y >= 4 && y < 12;
+			if (inside) reds += p[0] == 255 && p[2] == 0;
+			else CHECK(p[0] == 0 && p[2] == 255);
+		}
+	}
+	CHECK(reds == 16 * 8);
+
+	// hidden components draw nothing
+	c.hide();
+	r.render({&c}, {0, 0, 1, 1});
+	CHECK(pixel(r, 10, 6)[2] == 255);
+	c.show();
+
+	// text blends its glyph coverage with bgcolor, so a transparent background shows through between glyphs
+	UIText t(L"|");
+	t.setBGCol({0, 0, 0, 0});
+	r.render({&t}, {0, 0, 1, 1});
+	bool glyph = false, gap = false;
+	for (uint32_t x = 0; x < (uint32_t)t.getExt().x; x++) {
+		const unorm* p = pixel(r, x, (uint32_t)t.getExt().y / 2);
+		glyph |= p[0] == 255 && p[1] == 255;
+		gap |= p[0] == 0 && p[2] == 255;
+	}
+	CHECK(glyph && gap);
+
+	// the framebuffer round trips through PAM
+	CHECK(r.writePAM("software.pam"));
+	VkExtent2D e;
+	const std::vector<unorm> read = UISoftwareRenderer::readPAM("software.pam", e);
+	CHECK(e.width == 64 && e.height == 32);
+	CHECK(r.diff(read, 0) == 0);
+	r.render({&c}, {0, 0, 1, 1});
+	CHECK(r.diff(read, 0) > 0);
+	CHECK(UISoftwareRenderer::readPAM("missing.pam", e).empty());
+
+	return UI_TEST_RESULT;
+}
@@ -0,0 +1,61 @@
+#include "UITest.h"
+
+// UIStaticContainer draws and passes events like a UIContainer with the same children
+
+int main() {
+	UISoftwareRenderer r({128, 64});
+	useSoftwareRenderer(r);
+	const unorm white[4] = {255, 255, 255, 255};
+	r.setNoTex(white, {1, 1}, VK_FORMAT_R8G8B8A8_UNORM);
+
+	UIComponent a({4, 4}, {40, 20}), b({30, 10}, {40, 30});
+	a.setBGCol({1, 0, 0, 1});
+	b.setBGCol({0, 1, 0, 1});
+	UIText t(L"static", {8, 40});
+
+	UIStaticContainer<UIComponent, UIStaticContainer<UIComponent, UIText>> s(
+		{0, 0}, {128, 64}, a, UIStaticContainer<UIComponent, UIText>({0, 0}, {128, 64}, b, t));
+	UIContainer dyn;
+	dyn.setExt({128, 64});
+	dyn.addChild(a);
+	dyn.addChild(b);
+	dyn.addChild(t);
+
+	r.render({&dyn}, {0, 0, 0, 1});
+	const std::vector<unorm> golden = r.getPixels();
+	r.render({&s}, {0, 0, 0, 1});
+	CHECK(r.diff(golden, 0) == 0);
+
+	// children overlap in painter's order
+	std::vector<const UIComponent*> order;
+	UIComponent::setDefaultDrawFunc([&order] (const UIComponent* c, const VkCommandBuffer&) {order.push_back(c);});
+	s.draw(VK_NULL_HANDLE);
+	CHECK(order.size() == 5);
+	if (order.size() == 5) {
+		CHECK(order[0] == &s);
+		CHECK(order[1] == &s.get<0>());
+		CHECK(order[2] == &s.get<1>());
+		CHECK(order[3] == &s.get<1>().get<0>());
+		CHECK(order[4] == &s.get<1>().get<1>());
+	}
+	CHECK(s.getChildren().size() == 2);
+
+	// hiding the container hides everything in it
+	order.clear();
+	s.hide();
+	s.draw(VK_NULL_HANDLE);
+	CHECK(order.empty());
+	s.show();
+
+	// events reach nested children
+	uint32_t clicks = 0;
+	s.get<1>().get<0>().setOnClickBegin([&clicks] (UIComponent*, void*) {clicks++;});
+	s.listenMousePos({35, 15}, nullptr);
+	s.listenMouseClick(true, nullptr);
+	s.listenMouseClick(false, nullptr);
+	s.listenMousePos({120, 60}, nullptr);
+	s.listenMouseClick(true, nullptr);
+	CHECK(clicks == 1);
+
+	return UI_TEST_RESULT;
+}
@@ -0,0 +1,64 @@
+#include "UITest.h"
+
+// components share callbacks and pipelines through UIStyle handles instead of carrying copies
+
+int main() {
+	CHECK(sizeof(UIComponent) <= 64);
+
+	const size_t base = UIComponent::getNumStyles();
+	{
+		std::vector<UIComponent> many(1000, UIComponent({0, 0}, {10, 10}));
+		CHECK(UIComponent::getNumStyles() == base);
+		for (const UIComponent& c : many) CHECK(c.getStyleHandle() == UI_DEFAULT_STYLE);
+	}
+
+	// overriding copies the style once, copies of the component share the copy
+	{
+		UIComponent a({0, 0}, {10, 10});
+		uint32_t clicks = 0;
+		a.setOnClick([&clicks] (UIComponent*, void*) {clicks++;});
+		CHECK(a.getStyleHandle() != UI_DEFAULT_STYLE);
+		CHECK(UIComponent::getNumStyles() == base + 1);
+		UIComponent b(a);
+		CHECK(b.getStyleHandle() == a.getStyleHandle());
+		CHECK(UIComponent::getNumStyles() == base + 1);
+		// a is now shared, so changing it copies again rather than changing b
+		a.setCornerRadius(4);
+		CHECK(a.getStyleHandle() != b.getStyleHandle());
+		CHECK(b.getChrome().cornerradius == 0);
+		CHECK(UIComponent::getNumStyles() == base + 2);
+	}
+	CHECK(UIComponent::getNumStyles() == base);
+
+	// created styles outlive their users until destroyed
+	{
+		uint32_t draws = 0;
+		UIStyle s;
+		s.drawFunc = [&draws] (const UIComponent*, const VkCommandBuffer&) {draws++;};
+		const UIStyleHandle h = UIComponent::createStyle(s);
+		{
+			std::vector<UIComponent> styled(3, UIComponent({0, 0}, {10, 10}));
+			for (UIComponent& c : styled) c.setStyle(h);
+			for (const UIComponent& c : styled) c.draw(VK_NULL_HANDLE);
+			CHECK(draws == 3);
+		}
+		CHECK(UIComponent::getNumStyles() == base + 1);
+		UIComponent::destroyStyle(h);
+		CHECK(UIComponent::getNumStyles() == base);
+	}
+
+	// the same pipeline override on the same style is interned
+	{
+		UIPipelineInfo p;
+		p.pipeline = (VkPipeline)0x10;
+		UIComponent a, b;
+		a.setGraphicsPipeline(p);
+		b.setGraphicsPipeline(p);
+		CHECK(a.getStyleHandle() == b.getStyleHandle());
+		CHECK(a.getGraphicsPipeline().pipeline == p.pipeline);
+		CHECK(UIComponent::getNumStyles() == base + 1);
+	}
+	CHECK(UIComponent::getNumStyles() == base);
+
+	return UI_TEST_RESULT;
+}
@@ -0,0 +1,128 @@
+#include "UITest.h"
+
+// over budget, the least recently drawn hidden textures are evicted, and regenerated when next drawn
+
+int main() {
+	UISoftwareRenderer r({400, 100});
+	useSoftwareRenderer(r);
+	std::vector<VkImage> destroyed;
+	tdfType destroy = r.getTexDestroyFunc();
+	UIImage::setTexDestroyFunc([&] (UIImage* i) {
+		destroyed.push_back(i->getTex().image);
+		destroy(i);
+	});
+
+	// drawn in order, so a is least recently drawn
+	UIText a(L"aaaa"), b(L"bbbb"), c(L"cccc");
+	for (UIText* t : {&a, &b, &c}) r.render({t}, {0, 0, 0, 1});
+	const VkImage aimg = a.getTex().image, bimg = b.getTex().image;
+	const VkDeviceSize each = UIImage::texBytes(a.getTex());
+	CHECK(UIImage::getTexStats().residentbytes == each * 3);
+
+	// shown textures are never evicted
+	UIImage::setTexBudget(each);
+	UIImage::enforceTexBudget();
+	CHECK(UIImage::getTexStats().evictions == 0);
+	CHECK(destroyed.empty());
+
+	c.hide();
+	b.hide();
+	a.hide();
+	UIImage::enforceTexBudget();
+	CHECK(UIImage::getTexStats().evictions == 2);
+	CHECK(destroyed == std::vector<VkImage>({aimg, bimg}));
+	CHECK(c.getTex().image != UIComponent::getNoTex().image);
+	CHECK(UIImage::getTexStats().residentbytes == each);
+
+	// regenerated when drawn while shown, looking the same
+	UIText fresh(L"aaaa");
+	r.render({&fresh}, {0, 0, 0, 1});
+	const std::vector<unorm> golden = r.getPixels();
+	fresh.hide();
+	a.show();
+	r.render({&a}, {0, 0, 0, 1});
+	CHECK(r.diff(golden, 0) == 0);
+	CHECK(UIImage::getTexStats().evictions == 2);
+
+	// evicting one user of a shared texture frees nothing, so only the last counts
+	UIImage::setTexBudget(0);
+	{
+		UIText s1(L"shared"), s2(L"shared");
+		r.render({&s1, &s2}, {0, 0, 0, 1});
+		CHECK(s1.getTex().image == s2.getTex().image);
+		const VkImage simg = s1.getTex().image;
+		// copies of a hidden text can be evicted too
+		s1.hide();
+		UIText s3(s1);
+		s2.hide();
+		destroyed.clear();
+		const uint64_t evictions = UIImage::getTexStats().evictions;
+		UIImage::setTexBudget(1);
+		UIImage::enforceTexBudget();
+		CHECK(std::ranges::count(destroyed, simg) == 1);
+		CHECK(s1.getTex().image == UIComponent::getNoTex().image);
+		CHECK(s2.getTex().image == UIComponent::getNoTex().image);
+		CHECK(s3.getTex().image == UIComponent::getNoTex().image);
+		// simg and c's, fresh's was shared with a, which is still shown
+		CHECK(UIImage::getTexStats().evictions == evictions + 2);
+		CHECK(fresh.getTex().image == UIComponent::getNoTex().image);
+		CHECK(a.getTex().image != UIComponent::getNoTex().image);
+	}
+	UIImage::setTexBudget(0);
+
+	// text inside a hidden container is hidden too, however deep
+	{
+		UIContainer panel;
+		panel.setExt({400, 100});
+		UIText* label = panel.addChild(UIText(L"panel label"));
+		UIContainer* inner = panel.addChild(UIContainer());
+		inner->setExt({400, 100});
+		UIText* deep = inner->addChild(UIText(L"nested label", {0, 50}));
+		r.render({&panel}, {0, 0, 0, 1});
+		const std::vector<unorm> golden = r.getPixels();
+		const VkDeviceSize resident = UIImage::getTexStats().residentbytes;
+		const uint64_t evictions = UIImage::getTexStats().evictions;
+		UIImage::setTexBudget(1);
+		UIImage::enforceTexBudget();
+		CHECK(UIImage::getTexStats().evictions == evictions);
+		panel.hide();
+		UIImage::enforceTexBudget();
+		CHECK(UIImage::getTexStats().evictions == evictions + 2);
+		CHECK(UIImage::getTexStats().residentbytes < resident);
+		CHECK(label->getTex().image == UIComponent::getNoTex().image);
+		CHECK(deep->getTex().image == UIComponent::getNoTex().image);
+		UIImage::setTexBudget(0);
+		// and regenerated once it's shown and drawn
+		panel.show();
+		r.render({&panel}, {0, 0, 0, 1});
+		CHECK(r.diff(golden, 0) == 0);
+		// but not if it's hidden itself
+		deep->hide();
+		panel.hide();
+		panel.show();
+		UIImage::setTexBudget(1);
+		UIImage::enforceTexBudget();
+		CHECK(deep->getTex().image == UIComponent::getNoTex().image);
+		CHECK(label->getTex().image != UIComponent::getNoTex().image);
+		// children added to a hidden container are hidden too
+		UIText drawn(L"late label");
+		r.render({&drawn}, {0, 0, 0, 1});
+		panel.hide();
+		UIText* late = panel.addChild(drawn);
+		CHECK(late->getTex().image == drawn.getTex().image);
+		UIImage::enforceTexBudget();
+		CHECK(late->getTex().image == UIComponent::getNoTex().image);
+		CHECK(drawn.getTex().image != UIComponent::getNoTex().image);
+		UIImage::setTexBudget(0);
+	}
+
+	// only UIImages are treated as having a texture, whatever their push constant flags say
+	UIComponent plain({0, 0}, {10, 10});
+	plain.getPCDataPtr()->flags |= UI_PC_FLAG_TEX;
+	r.render({&plain}, {0, 0, 0, 1});
+	std::vector<UIDrawData> items;
+	plain.collectDrawData(items);
+	CHECK(items.size() == 1 && items[0].image == VK_NULL_HANDLE);
+
+	return UI_TEST_RESULT;
+}
@@ -0,0 +1,90 @@
+#include "UITest.h"
+
+// measureText lays text out as UIText draws it, breaking lines to fit a width
+
+static bool sameExt(UICoord a, UICoord b) {
+	return fabsf(a.x - b.x) < 0.01f && fabsf(a.y - b.y) < 0.01f;
+}
+
+int main() {
+	UISoftwareRenderer r({200, 200});
+	useSoftwareRenderer(r);
+
+	// measured extents are what UITexts of the same text are
+	for (const std::wstring& s : {std::wstring(L"x"), std::wstring(L"measure me"), std::wstring(L"two\nlines"),
+		std::wstring(L"trailing\n")}) {
+		CHECK(sameExt(UIText::measureText(s).extent, UIText(s).getExt()));
+	}
+
+	// lines break at newlines, which aren't part of either line
+	UITextMetrics m = UIText::measureText(L"ab\ncde");
+	CHECK(m.lines.size() == 2);
+	CHECK(m.lines[0].begin == 0 && m.lines[0].end == 2);
+	CHECK(m.lines[1].begin == 3 && m.lines[1].end == 6);
+	CHECK(m.lines[1].width > m.lines[0].width);
+	CHECK(m.extent.x >= m.lines[1].width);
+	const float lineheight = UIText::measureText(L"ab").extent.y;
+	CHECK(m.extent.y > lineheight);
+
+	// widths add up, less any kerning between the pair
+	const float a = UIText::measureText(L"A").extent.x, v = UIText::measureText(L"V").extent.x;
+	CHECK(UIText::measureText(L"AV").extent.x <= a + v + 0.01f);
+	CHECK(UIText::measureText(L"AV").extent.x > std::max(a, v));
+
+	// wrapping breaks at spaces to fit, and the spaces it broke at don't count
+	const std::wstring sentence = L"the quick brown fox jumps over the lazy dog";
+	const float one = UIText::measureText(sentence).extent.x;
+	const float maxwidth = one / 3;
+	m = UIText::measureText(sentence, maxwidth);
+	CHECK(m.lines.size() >= 3);
+	for (const UITextLine& l : m.lines) {
+		CHECK(l.width <= maxwidth);
+		CHECK(sentence[l.begin] != L' ' && sentence[l.end - 1] != L' ');
+		CHECK(l.end == sentence.size() || sentence[l.end] == L' ');
+	}
+	CHECK(m.extent.x <= maxwidth);
+	// a word too long for a line on its own is broken mid-word
+	m = UIText::measureText(L"abcdefghijklmnopqrstuvwxyz", UIText::measureText(L"abcdef").extent.x);
+	CHECK(m.lines.size() >= 4);
+	for (size_t i = 1; i < m.lines.size(); i++) CHECK(m.lines[i].begin == m.lines[i - 1].end);
+	// a width of 0 doesn't wrap
+	CHECK(UIText::measureText(sentence, 0).lines.size() == 1);
+
+	// wrapped UITexts are the measured extent and draw within it
+	UIText t(sentence);
+	t.setWrapWidth(maxwidth);
+	CHECK(sameExt(t.getExt(), UIText::measureText(sentence, maxwidth).extent));
+	t.setBGCol({0, 0, 0, 0});
+	r.render({&t}, {0, 0, 0, 1});
+	size_t inside = 0;
+	for (uint32_t y = 0; y < 200; y++) {
+		for (uint32_t x = 0; x < 200; x++) {
+			const unorm* p = &r.getPixels()[((size_t)y * 200 + x) * 4];
+			if (p[0] == 0) continue;
+			CHECK(x < ceilf(t.getExt().x) && 200 - 1 - y < ceilf(t.getExt().y));
+			inside++;
+		}
+	}
+	CHECK(inside > 0);
+
+	// glyphs are drawn where they were measured, so the last of a run looks like the first on its own
+	const float glyph = UIText::measureText(L"m").extent.x;
+	const std::wstring run((size_t)(190 / glyph), L'm');
+	const float last = UIText::measureText(run).extent.x - glyph;
+	UIText single(L"m"), many(run);
+	single.setBGCol({0, 0, 0, 0});
+	many.setBGCol({0, 0, 0, 0});
+	r.render({&single}, {0, 0, 0, 1});
+	const std::vector<unorm> alone = r.getPixels();
+	r.render({&many}, {0, 0, 0, 1});
+	size_t differing = 0;
+	for (uint32_t y = 0; y < 200; y++) {
+		for (uint32_t x = 0; x < (uint32_t)glyph; x++) {
+			const size_t i = ((size_t)y * 200 + x) * 4, j = ((size_t)y * 200 + x + (uint32_t)last) * 4;
+			if (alone[i] != r.getPixels()[j]) differing++;
+		}
+	}
+	CHECK(differing == 0);
+
+	return UI_TEST_RESULT;
+}
@@ -0,0 +1,51 @@
+#include "UITest.h"
+
+// changing text redraws into the existing texture when it fits, and looks like new text would
+
+int main() {
+	UISoftwareRenderer r({96, 32});
+	useSoftwareRenderer(r);
+
+	// what each text looks like with a texture of its own
+	std::vector<std::wstring> texts;
+	for (uint32_t i = 0; i < 60; i++) texts.push_back(std::to_wstring(i * 37 % 1000) + (i % 7 ? L"" : L" ms"));
+	std::vector<std::vector<unorm>> golden;
+	for (const std::wstring& s : texts) {
+		UIText t(s);
+		r.render({&t}, {0, 0, 0, 1});
+		golden.push_back(r.getPixels());
+	}
+
+	UIImage::setTexUpdateFunc(r.getTexUpdateFunc());
+	const UITexStats before = UIImage::getTexStats();
+	UIText counter(texts[0]);
+	for (size_t i = 0; i < texts.size(); i++) {
+		counter.setText(texts[i]);
+		r.render({&counter}, {0, 0, 0, 1});
+		CHECK(r.diff(golden[i], 0) == 0);
+		// only the part of the texture the text covers is drawn
+		const VkExtent2D region = UIImage::getTexRegion(counter.getPCData());
+		CHECK(region.width <= counter.getTexInfo()->extent.width && region.height <= counter.getTexInfo()->extent.height);
+	}
+	const UITexStats after = UIImage::getTexStats();
+	// the texture grows with room to spare a few times, then every change is an update
+	CHECK(after.loads - before.loads <= 4);
+	CHECK(after.updates - before.updates >= texts.size() - 4);
+
+	// shared textures aren't drawn over
+	UIText a(L"shared"), b(L"shared");
+	r.render({&a, &b}, {0, 0, 0, 1});
+	CHECK(a.getTexInfo()->image == b.getTexInfo()->image);
+	const uint64_t updates = UIImage::getTexStats().updates;
+	a.setText(L"shaded");
+	r.render({&a, &b}, {0, 0, 0, 1});
+	CHECK(UIImage::getTexStats().updates == updates);
+	CHECK(a.getTexInfo()->image != b.getTexInfo()->image);
+	const std::vector<unorm> both = r.getPixels();
+	UIImage::setTexUpdateFunc(nullptr);
+	UIText a2(L"shaded"), b2(L"shared");
+	r.render({&a2, &b2}, {0, 0, 0, 1});
+	CHECK(r.diff(both, 0) == 0);
+
+	return UI_TEST_RESULT;
+}
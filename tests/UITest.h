@@ -0,0 +1,29 @@
+#pragma once
+
+#include "UISoftware.h"
+#include <cstdio>
+
+/*
+ * Each test file is its own executable, run by ctest. CHECK reports where a condition failed and keeps going,
+ * and main returns UI_TEST_RESULT so a failure anywhere fails that test.
+ */
+static uint32_t uitestfailures = 0;
+
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+		uitestfailures++; \
+	} \
+} while (0)
+
+#define UI_TEST_RESULT (uitestfailures == 0 ? 0 : 1)
+
+// makes r the host, as in UISoftware.h, with a transparent notex
+inline void useSoftwareRenderer(UISoftwareRenderer& r) {
+	static const unorm transparent[4] = {0, 0, 0, 0};
+	UIComponent::setScreenExtent(r.getExtent());
+	UIComponent::setDefaultDrawFunc(r.getDrawFunc());
+	UIImage::setTexLoadFunc(r.getTexLoadFunc());
+	UIImage::setTexDestroyFunc(r.getTexDestroyFunc());
+	r.setNoTex(transparent, {1, 1}, VK_FORMAT_R8G8B8A8_UNORM);
+}
@@ -0,0 +1,4 @@
+// stands in for the header EmbedSPIRV.cmake generates, the stub never looks past the magic number
+static const uint32_t UIFragmentSPIRV[] = {
+0x07230203,
+};
@@ -0,0 +1,105 @@
+#include "VulkanStub.h"
+#include <cstring>
+#include <mutex>
+
+// handles only need to be distinct and non-null
+static uintptr_t nexthandle = 0x1000;
+static std::mutex stubmutex;
+
+template<class T>
+static T makeHandle() {
+	std::lock_guard<std::mutex> lock(stubmutex);
+	return (T)(nexthandle++);
+}
+
+VulkanStubLog& vulkanStubLog() {
+	static VulkanStubLog log = {};
+	return log;
+}
+
+extern "C" {
+
+VkResult vkBeginCommandBuffer(VkCommandBuffer cb, const VkCommandBufferBeginInfo*) {
+	std::lock_guard<std::mutex> lock(stubmutex);
+	vulkanStubLog().begun.push_back(cb);
+	return VK_SUCCESS;
+}
+
+VkResult vkEndCommandBuffer(VkCommandBuffer) {return VK_SUCCESS;}
+
+void vkCmdExecuteCommands(VkCommandBuffer, uint32_t n, const VkCommandBuffer* cbs) {
+	vulkanStubLog().executecalls++;
+	vulkanStubLog().executed.insert(vulkanStubLog().executed.end(), cbs, cbs + n);
+}
+
+void vkGetPhysicalDeviceProperties(VkPhysicalDevice, VkPhysicalDeviceProperties* p) {
+	memset(p, 0, sizeof(*p));
+	p->vendorID = 0x10de;
+	p->deviceID = 0x1234;
+	for (uint8_t i = 0; i < VK_UUID_SIZE; i++) p->pipelineCacheUUID[i] = i;
+}
+
+VkResult vkCreatePipelineCache(VkDevice, const VkPipelineCacheCreateInfo*, const VkAllocationCallbacks*, VkPipelineCache* c) {
+	*c = makeHandle<VkPipelineCache>();
+	return VK_SUCCESS;
+}
+
+void vkDestroyPipelineCache(VkDevice, VkPipelineCache, const VkAllocationCallbacks*) {}
+
+// a header vkGetPhysicalDeviceProperties' device would accept, followed by filler
+VkResult vkGetPipelineCacheData(VkDevice, VkPipelineCache, size_t* n, void* d) {
+	if (!d) {
+		*n = 64;
+		return VK_SUCCESS;
+	}
+	const uint32_t header[4] = {32, VK_PIPELINE_CACHE_HEADER_VERSION_ONE, 0x10de, 0x1234};
+	memset(d, 7, *n);
+	memcpy(d, header, sizeof(header));
+	for (uint8_t i = 0; i < VK_UUID_SIZE; i++) ((uint8_t*)d)[sizeof(header) + i] = i;
+	return VK_SUCCESS;
+}
+
+VkResult vkCreateShaderModule(VkDevice, const VkShaderModuleCreateInfo*, const VkAllocationCallbacks*, VkShaderModule* m) {
+	*m = makeHandle<VkShaderModule>();
+	return VK_SUCCESS;
+}
+
+void vkDestroyShaderModule(VkDevice, VkShaderModule, const VkAllocationCallbacks*) {}
+
+VkResult vkCreateDescriptorSetLayout(
+		VkDevice,
+		const VkDescriptorSetLayoutCreateInfo*,
+		const VkAllocationCallbacks*,
+		VkDescriptorSetLayout* l) {
+	*l = makeHandle<VkDescriptorSetLayout>();
+	return VK_SUCCESS;
+}
+
+void vkDestroyDescriptorSetLayout(VkDevice, VkDescriptorSetLayout, const VkAllocationCallbacks*) {}
+
+VkResult vkCreatePipelineLayout(VkDevice, const VkPipelineLayoutCreateInfo*, const VkAllocationCallbacks*, VkPipelineLayout* l) {
+	*l = makeHandle<VkPipelineLayout>();
+	return VK_SUCCESS;
+}
+
+void vkDestroyPipelineLayout(VkDevice, VkPipelineLayout, const VkAllocationCallbacks*) {}
+
+VkResult vkCreateGraphicsPipelines(
+		VkDevice,
+		VkPipelineCache,
+		uint32_t,
+		const VkGraphicsPipelineCreateInfo* ci,
+		const VkAllocationCallbacks*,
+		VkPipeline* p) {
+	const VkSpecializationInfo* spec = ci->pStages[0].pSpecializationInfo;
+	if (spec && spec->dataSize >= sizeof(vulkanStubLog().specdata)) {
+		memcpy(vulkanStubLog().specdata, spec->pData, sizeof(vulkanStubLog().specdata));
+	}
+	vulkanStubLog().pipelines++;
+	*p = makeHandle<VkPipeline>();
+	return VK_SUCCESS;
+}
+
+void vkDestroyPipeline(VkDevice, VkPipeline, const VkAllocationCallbacks*) {}
+
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+// what the faked entry points in VulkanStub.cpp have been asked to do, for tests to check
+typedef struct VulkanStubLog {
+	std::vector<VkCommandBuffer> begun, executed;
+	uint32_t executecalls;
+	uint32_t pipelines;
+	float specdata[2]; // screen extent baked into the last pipeline, see UIPipelineBuilder
+} VulkanStubLog;
+
+VulkanStubLog& vulkanStubLog();
@@ -0,0 +1,106 @@
+#pragma once
+
+/*
+ * Just enough of the Vulkan API for the library to compile against, so the tests build and run without the
+ * SDK or a GPU. Drawing goes through UISoftwareRenderer, and the few entry points the library calls are
+ * faked in VulkanStub.cpp. Values match the real headers where the library relies on them.
+ */
+#include <cstdint>
+#include <cstddef>
+#define VK_NULL_HANDLE nullptr
+#define VK_DEFINE_HANDLE(o) typedef struct o##_T* o;
+VK_DEFINE_HANDLE(VkImage) VK_DEFINE_HANDLE(VkDeviceMemory) VK_DEFINE_HANDLE(VkImageView)
+VK_DEFINE_HANDLE(VkPipelineLayout) VK_DEFINE_HANDLE(VkPipeline) VK_DEFINE_HANDLE(VkDescriptorSetLayout)
+VK_DEFINE_HANDLE(VkDescriptorSet) VK_DEFINE_HANDLE(VkCommandBuffer) VK_DEFINE_HANDLE(VkCommandPool)
+VK_DEFINE_HANDLE(VkDevice) VK_DEFINE_HANDLE(VkPipelineCache) VK_DEFINE_HANDLE(VkShaderModule) VK_DEFINE_HANDLE(VkRenderPass)
+VK_DEFINE_HANDLE(VkSampler)
+typedef uint32_t VkFlags; typedef uint32_t VkBool32; typedef uint64_t VkDeviceSize;
+typedef enum VkStructureType { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO = 32,
+ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO = 40, VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO = 41,
+ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO = 42, VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO = 17,
+ VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO = 16, VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO = 30,
+ VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO = 28, VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO = 18,
+ VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO = 19, VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO = 20,
+ VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO = 22, VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO = 23,
+ VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO = 24, VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO = 26,
+ VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO = 27 } VkStructureType;
+typedef enum VkFormat { VK_FORMAT_UNDEFINED = 0, VK_FORMAT_R8_UNORM = 9, VK_FORMAT_R8G8B8A8_UNORM = 37, VK_FORMAT_R8G8B8A8_SRGB = 43,
+ VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131, VK_FORMAT_BC1_RGBA_UNORM_BLOCK = 133, VK_FORMAT_BC3_UNORM_BLOCK = 137, VK_FORMAT_BC4_UNORM_BLOCK = 139, VK_FORMAT_BC7_UNORM_BLOCK = 145 } VkFormat;
+typedef enum VkImageLayout { VK_IMAGE_LAYOUT_UNDEFINED = 0 } VkImageLayout;
+typedef enum VkResult { VK_SUCCESS = 0, VK_INCOMPLETE = 5 } VkResult;
+typedef enum VkCommandBufferLevel { VK_COMMAND_BUFFER_LEVEL_PRIMARY = 0, VK_COMMAND_BUFFER_LEVEL_SECONDARY = 1 } VkCommandBufferLevel;
+typedef VkFlags VkShaderStageFlags; typedef VkFlags VkDescriptorSetLayoutCreateFlags;
+typedef enum VkShaderStageFlagBits { VK_SHADER_STAGE_VERTEX_BIT = 1, VK_SHADER_STAGE_FRAGMENT_BIT = 16 } VkShaderStageFlagBits;
+typedef enum VkCommandBufferUsageFlagBits { VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT = 2 } VkCommandBufferUsageFlagBits;
+typedef enum VkDescriptorType { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER = 1 } VkDescriptorType;
+typedef struct VkExtent2D { uint32_t width, height; } VkExtent2D;
+typedef struct VkOffset2D { int32_t x, y; } VkOffset2D;
+typedef struct VkRect2D { VkOffset2D offset; VkExtent2D extent; } VkRect2D;
+typedef struct VkDescriptorSetLayoutBinding { uint32_t binding; VkDescriptorType descriptorType; uint32_t descriptorCount; VkShaderStageFlags stageFlags; const VkSampler* pImmutableSamplers; } VkDescriptorSetLayoutBinding;
+typedef struct VkDescriptorSetLayoutCreateInfo { VkStructureType sType; const void* pNext; VkDescriptorSetLayoutCreateFlags flags; uint32_t bindingCount; const VkDescriptorSetLayoutBinding* pBindings; } VkDescriptorSetLayoutCreateInfo;
+typedef struct VkPushConstantRange { VkShaderStageFlags stageFlags; uint32_t offset; uint32_t size; } VkPushConstantRange;
+typedef struct VkSpecializationInfo { uint32_t mapEntryCount; const void* pMapEntries; size_t dataSize; const void* pData; } VkSpecializationInfo;
+VK_DEFINE_HANDLE(VkFramebuffer)
+typedef VkFlags VkCommandBufferUsageFlags; typedef VkFlags VkQueryControlFlags; typedef VkFlags VkQueryPipelineStatisticFlags;
+#define VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT 1
+typedef struct VkCommandBufferInheritanceInfo { VkStructureType sType; const void* pNext; VkRenderPass renderPass; uint32_t subpass; VkFramebuffer framebuffer; VkBool32 occlusionQueryEnable; VkQueryControlFlags queryFlags; VkQueryPipelineStatisticFlags pipelineStatistics; } VkCommandBufferInheritanceInfo;
+typedef struct VkCommandBufferBeginInfo { VkStructureType sType; const void* pNext; VkCommandBufferUsageFlags flags; const VkCommandBufferInheritanceInfo* pInheritanceInfo; } VkCommandBufferBeginInfo;
+extern "C" {
+VkResult vkBeginCommandBuffer(VkCommandBuffer, const VkCommandBufferBeginInfo*);
+VkResult vkEndCommandBuffer(VkCommandBuffer);
+void vkCmdExecuteCommands(VkCommandBuffer, uint32_t, const VkCommandBuffer*);
+}
+// pipeline builder additions
+VK_DEFINE_HANDLE(VkPhysicalDevice)
+#define VK_UUID_SIZE 16
+#define VK_FALSE 0
+#define VK_TRUE 1
+typedef enum VkPipelineCacheHeaderVersion { VK_PIPELINE_CACHE_HEADER_VERSION_ONE = 1 } VkPipelineCacheHeaderVersion;
+typedef enum VkSampleCountFlagBits { VK_SAMPLE_COUNT_1_BIT = 1 } VkSampleCountFlagBits;
+typedef enum VkPrimitiveTopology { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST = 3 } VkPrimitiveTopology;
+typedef enum VkPolygonMode { VK_POLYGON_MODE_FILL = 0 } VkPolygonMode;
+typedef enum VkCullModeFlagBits { VK_CULL_MODE_NONE = 0 } VkCullModeFlagBits; typedef VkFlags VkCullModeFlags;
+typedef enum VkFrontFace { VK_FRONT_FACE_COUNTER_CLOCKWISE = 0 } VkFrontFace;
+typedef enum VkCompareOp { VK_COMPARE_OP_ALWAYS = 7 } VkCompareOp;
+typedef enum VkBlendFactor { VK_BLEND_FACTOR_ONE = 1, VK_BLEND_FACTOR_SRC_ALPHA = 6, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA = 7 } VkBlendFactor;
+typedef enum VkBlendOp { VK_BLEND_OP_ADD = 0 } VkBlendOp;
+typedef enum VkLogicOp { VK_LOGIC_OP_COPY = 3 } VkLogicOp;
+typedef enum VkColorComponentFlagBits { VK_COLOR_COMPONENT_R_BIT = 1, VK_COLOR_COMPONENT_G_BIT = 2, VK_COLOR_COMPONENT_B_BIT = 4, VK_COLOR_COMPONENT_A_BIT = 8 } VkColorComponentFlagBits;
+typedef VkFlags VkColorComponentFlags;
+typedef enum VkDynamicState { VK_DYNAMIC_STATE_VIEWPORT = 0, VK_DYNAMIC_STATE_SCISSOR = 1 } VkDynamicState;
+typedef enum VkStencilOp { VK_STENCIL_OP_KEEP = 0 } VkStencilOp;
+#define VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO ((VkStructureType)25)
+typedef struct VkAllocationCallbacks VkAllocationCallbacks;
+typedef struct VkPhysicalDeviceLimits { uint32_t dummy; } VkPhysicalDeviceLimits;
+typedef struct VkPhysicalDeviceSparseProperties { VkBool32 dummy; } VkPhysicalDeviceSparseProperties;
+typedef struct VkPhysicalDeviceProperties { uint32_t apiVersion; uint32_t driverVersion; uint32_t vendorID; uint32_t deviceID; uint32_t deviceType; char deviceName[256]; uint8_t pipelineCacheUUID[VK_UUID_SIZE]; VkPhysicalDeviceLimits limits; VkPhysicalDeviceSparseProperties sparseProperties; } VkPhysicalDeviceProperties;
+typedef struct VkPipelineCacheCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; size_t initialDataSize; const void* pInitialData; } VkPipelineCacheCreateInfo;
+typedef struct VkShaderModuleCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; size_t codeSize; const uint32_t* pCode; } VkShaderModuleCreateInfo;
+typedef struct VkPipelineLayoutCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; uint32_t setLayoutCount; const VkDescriptorSetLayout* pSetLayouts; uint32_t pushConstantRangeCount; const VkPushConstantRange* pPushConstantRanges; } VkPipelineLayoutCreateInfo;
+typedef struct VkSpecializationMapEntry { uint32_t constantID; uint32_t offset; size_t size; } VkSpecializationMapEntry;
+typedef struct VkPipelineShaderStageCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; VkShaderStageFlagBits stage; VkShaderModule module; const char* pName; const VkSpecializationInfo* pSpecializationInfo; } VkPipelineShaderStageCreateInfo;
+typedef struct VkPipelineVertexInputStateCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; uint32_t vertexBindingDescriptionCount; const void* pVertexBindingDescriptions; uint32_t vertexAttributeDescriptionCount; const void* pVertexAttributeDescriptions; } VkPipelineVertexInputStateCreateInfo;
+typedef struct VkPipelineInputAssemblyStateCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; VkPrimitiveTopology topology; VkBool32 primitiveRestartEnable; } VkPipelineInputAssemblyStateCreateInfo;
+typedef struct VkPipelineViewportStateCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; uint32_t viewportCount; const void* pViewports; uint32_t scissorCount; const VkRect2D* pScissors; } VkPipelineViewportStateCreateInfo;
+typedef struct VkPipelineRasterizationStateCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; VkBool32 depthClampEnable; VkBool32 rasterizerDiscardEnable; VkPolygonMode polygonMode; VkCullModeFlags cullMode; VkFrontFace frontFace; VkBool32 depthBiasEnable; float depthBiasConstantFactor; float depthBiasClamp; float depthBiasSlopeFactor; float lineWidth; } VkPipelineRasterizationStateCreateInfo;
+typedef struct VkPipelineMultisampleStateCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; VkSampleCountFlagBits rasterizationSamples; VkBool32 sampleShadingEnable; float minSampleShading; const uint32_t* pSampleMask; VkBool32 alphaToCoverageEnable; VkBool32 alphaToOneEnable; } VkPipelineMultisampleStateCreateInfo;
+typedef struct VkStencilOpState { VkStencilOp failOp, passOp, depthFailOp; VkCompareOp compareOp; uint32_t compareMask, writeMask, reference; } VkStencilOpState;
+typedef struct VkPipelineDepthStencilStateCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; VkBool32 depthTestEnable; VkBool32 depthWriteEnable; VkCompareOp depthCompareOp; VkBool32 depthBoundsTestEnable; VkBool32 stencilTestEnable; VkStencilOpState front; VkStencilOpState back; float minDepthBounds; float maxDepthBounds; } VkPipelineDepthStencilStateCreateInfo;
+typedef struct VkPipelineColorBlendAttachmentState { VkBool32 blendEnable; VkBlendFactor srcColorBlendFactor; VkBlendFactor dstColorBlendFactor; VkBlendOp colorBlendOp; VkBlendFactor srcAlphaBlendFactor; VkBlendFactor dstAlphaBlendFactor; VkBlendOp alphaBlendOp; VkColorComponentFlags colorWriteMask; } VkPipelineColorBlendAttachmentState;
+typedef struct VkPipelineColorBlendStateCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; VkBool32 logicOpEnable; VkLogicOp logicOp; uint32_t attachmentCount; const VkPipelineColorBlendAttachmentState* pAttachments; float blendConstants[4]; } VkPipelineColorBlendStateCreateInfo;
+typedef struct VkPipelineDynamicStateCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; uint32_t dynamicStateCount; const VkDynamicState* pDynamicStates; } VkPipelineDynamicStateCreateInfo;
+typedef struct VkGraphicsPipelineCreateInfo { VkStructureType sType; const void* pNext; VkFlags flags; uint32_t stageCount; const VkPipelineShaderStageCreateInfo* pStages; const VkPipelineVertexInputStateCreateInfo* pVertexInputState; const VkPipelineInputAssemblyStateCreateInfo* pInputAssemblyState; const void* pTessellationState; const VkPipelineViewportStateCreateInfo* pViewportState; const VkPipelineRasterizationStateCreateInfo* pRasterizationState; const VkPipelineMultisampleStateCreateInfo* pMultisampleState; const VkPipelineDepthStencilStateCreateInfo* pDepthStencilState; const VkPipelineColorBlendStateCreateInfo* pColorBlendState; const VkPipelineDynamicStateCreateInfo* pDynamicState; VkPipelineLayout layout; VkRenderPass renderPass; uint32_t subpass; VkPipeline basePipelineHandle; int32_t basePipelineIndex; } VkGraphicsPipelineCreateInfo;
+extern "C" {
+void vkGetPhysicalDeviceProperties(VkPhysicalDevice, VkPhysicalDeviceProperties*);
+VkResult vkCreatePipelineCache(VkDevice, const VkPipelineCacheCreateInfo*, const VkAllocationCallbacks*, VkPipelineCache*);
+void vkDestroyPipelineCache(VkDevice, VkPipelineCache, const VkAllocationCallbacks*);
+VkResult vkGetPipelineCacheData(VkDevice, VkPipelineCache, size_t*, void*);
+VkResult vkCreateShaderModule(VkDevice, const VkShaderModuleCreateInfo*, const VkAllocationCallbacks*, VkShaderModule*);
+void vkDestroyShaderModule(VkDevice, VkShaderModule, const VkAllocationCallbacks*);
+VkResult vkCreateDescriptorSetLayout(VkDevice, const VkDescriptorSetLayoutCreateInfo*, const VkAllocationCallbacks*, VkDescriptorSetLayout*);
+void vkDestroyDescriptorSetLayout(VkDevice, VkDescriptorSetLayout, const VkAllocationCallbacks*);
+VkResult vkCreatePipelineLayout(VkDevice, const VkPipelineLayoutCreateInfo*, const VkAllocationCallbacks*, VkPipelineLayout*);
+void vkDestroyPipelineLayout(VkDevice, VkPipelineLayout, const VkAllocationCallbacks*);
+VkResult vkCreateGraphicsPipelines(VkDevice, VkPipelineCache, uint32_t, const VkGraphicsPipelineCreateInfo*, const VkAllocationCallbacks*, VkPipeline*);
+void vkDestroyPipeline(VkDevice, VkPipeline, const VkAllocationCallbacks*);
+}